@@ -286,18 +286,36 @@ copydone:
 #endif /* __ONLY_INIT_SP */
 
 
+/* Byte the stack is painted with; must equal STACK_PAINT in mouse.h, whose
+   probes in stack.c look for the deepest byte that still holds it */
+#define STACK_PAINT 0xA5
+
+extern char __SEG_START_SSTACK[];
+extern char __SEG_END_SSTACK[];
+
+
 #pragma NO_EXIT
 __EXTERN_C void _Startup(void) {
 /* set the reset vector to _Startup in the linker parameter file (*.prm):
     'VECTOR 0 _Startup'
 
     purpose:    1)  initialize the stack
-                2)  initialize run-time, ...
+                2)  paint the stack with STACK_PAINT
+                3)  initialize run-time, ...
                     initialize the RAM, copy down init data, etc (Init)
-                3)  call main;
+                4)  call main;
     called from: _PRESTART-code generated by the Linker
 */
   INIT_SP_FROM_STARTUP_DESC();
+  asm {
+             LDHX   #__SEG_START_SSTACK
+             LDA    #STACK_PAINT
+PaintStack:
+             STA    0,X
+             AIX    #1
+             CPHX   #__SEG_END_SSTACK   ; // nothing is on the stack yet
+             BNE    PaintStack
+  }
 #ifndef  __ONLY_INIT_SP
   Init();
 #endif
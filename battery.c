@@ -0,0 +1,100 @@
+///
+/// @file       battery.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements battery voltage monitoring and the compensation of
+///             PWM duty cycles for the battery voltage.
+///
+/// @remarks    TaskNavigate() samples the battery through batteryChannel; an
+///             exponential filter smooths out the sag under PWM current.
+///             ControlMotor() scales pwLeft and pwRight by batteryScale, the
+///             ratio of BATTERY_NOMINAL to the filtered voltage, so that a
+///             duty cycle gives the same motor voltage over the whole
+///             discharge. batteryLow is set, with hysteresis, once the
+///             voltage falls below BATTERY_LOW; the mode loops stop the
+///             mouse while it is set.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static byte batterySeeded;  // batteryLevel holds a sample
+
+
+// start without a sample: no scaling until the first one
+void BatteryInit(void)
+{
+    batterySeeded = 0;
+    batteryLevel = (word)BATTERY_COUNTS(BATTERY_NOMINAL) << 8;
+    batteryScale = Q8_8_ONE;
+    batteryLow = 0;
+}
+
+
+// take one sample; called by TaskNavigate()
+void BatterySample(void)
+{
+    byte sample;
+    word level;
+
+    sample = ADCConvert(batteryChannel);
+    TRACE_RECORD(TRACE_ADC | batteryChannel, sample);
+    if (sample < BATTERY_COUNTS(BATTERY_ABSENT)) {
+        batteryScale = Q8_8_ONE;    // nothing on batteryChannel
+        return;
+    }
+
+    if (!batterySeeded) {
+        batteryLevel = (word)sample << 8;
+        batterySeeded = 1;
+    }
+    else {
+        batteryLevel += (word)((((long)sample << 8) - (long)batteryLevel) >> BATTERY_FILTER);
+    }
+
+    level = batteryLevel >> 8;
+    batteryScale = (word)(((dword)BATTERY_COUNTS(BATTERY_NOMINAL) << 8) / level);
+    if (level < BATTERY_COUNTS(BATTERY_LOW)) {
+        batteryLow = 1;
+    }
+    else if (level >= BATTERY_COUNTS(BATTERY_LOW + BATTERY_HYSTERESIS)) {
+        batteryLow = 0;
+    }
+}
+
+
+// duty cycle in percent that gives the motor voltage of 'pw' at BATTERY_NOMINAL
+word BatteryDuty(word pw)
+{
+    word duty = (word)(((dword)pw * batteryScale) >> 8);
+
+    return (duty > 100) ? 100 : duty;
+}
+
+
+// filtered battery voltage in mV
+word BatteryMillivolts(void)
+{
+    return (word)(((dword)batteryLevel * batteryDivider * adcReference) >> 16);
+}
+
+
+// report the battery voltage on the SCI
+void BatteryReport(void)
+{
+    SCISendStr("battery ");
+    SCISendDec(BatteryMillivolts());
+    SCISendStr(" mV, duty x");
+    SCISendDec((word)(((dword)batteryScale * 100) >> 8));
+    SCISendStr("%");
+    if (batteryLow) {
+        SCISendStr(", low");
+    }
+    SCISendNewLine();
+}
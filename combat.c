@@ -0,0 +1,211 @@
+///
+/// @file       combat.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the state machine of the combat mode.
+///
+/// @remarks    CombatStep() runs in every input period, in TaskInput() right
+///             after the inputs have been debounced, so that the motors get
+///             their new command in the very tick in which a change of the
+///             touch bars or the IR sensors is accepted; the reaction to an
+///             edge thus takes at most INPUT_DEBOUNCE input periods. A front
+///             touch bar on the opponent means a push, a hit from behind or
+///             a push from the wheel monitor an evasion, both IR sensors a
+///             charge and one a turn towards that side; with nothing seen the
+///             mouse rotates towards where it saw the opponent last. Charges
+///             and pushes are driven open loop by CombatDrive() in TaskControl()
+///             instead of the speed controller: a charge at pwMax, a push in
+///             bursts of COMBAT_BURST control periods at pwMax with
+///             COMBAT_EASE less in between, and less on a slipping wheel;
+///             Enter() writes their first duty cycles itself, so that every
+///             reaction reaches the motor registers in CombatStep(). The
+///             reactions are timed by 'latency.c' like those of every mode;
+///             CombatReport() reports the histogram of the combat mode.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#define FRONT   (INPUT_TOUCH_FRONT_LEFT | INPUT_TOUCH_FRONT_RIGHT)
+#define REAR    (INPUT_TOUCH_REAR_LEFT | INPUT_TOUCH_REAR_RIGHT)
+#define IR      (INPUT_IR_FRONT_LEFT | INPUT_IR_FRONT_RIGHT)
+
+
+static signed char combatSide;  // side of the opponent, or of a hit: 1 left, -1 right
+static byte combatTouch;        // front touch bars on the opponent
+static byte combatTimer;        // input periods left of an evasion
+static byte combatPhase;        // control periods into the burst cycle of a push
+
+
+// write the duty cycles of a charge or a push, in 'state', at the current
+// phase of the burst cycle
+static void Drive(CombatState state)
+{
+    int duty[2];
+    byte i;
+
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = (int)pwMax;
+    if (state == COMBAT_PUSH) {
+        if (combatPhase >= COMBAT_BURST) {
+            duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = (int)pwMax - COMBAT_EASE;
+        }
+        // a single touch bar on the opponent turns the mouse square to it
+        if (combatTouch == INPUT_TOUCH_FRONT_LEFT) {
+            duty[MOTOR_LEFT] -= COMBAT_STEER;
+        }
+        else if (combatTouch == INPUT_TOUCH_FRONT_RIGHT) {
+            duty[MOTOR_RIGHT] -= COMBAT_STEER;
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        if (wheelState[i] & WHEEL_SLIP) {
+            duty[i] -= COMBAT_EASE;     // more torque would only spin it
+        }
+        if (duty[i] < (int)pwMin) {
+            duty[i] = (int)pwMin;
+        }
+    }
+    pwLeft = (word)duty[MOTOR_LEFT];
+    pwRight = (word)duty[MOTOR_RIGHT];
+    ControlMotor(MOTOR_LEFT, MOTOR_ACTION_FORWARD);
+    ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_FORWARD);
+}
+
+
+// command the motors for 'state'
+static void Enter(CombatState state)
+{
+    LatencyCommand();   // a push or a charge changes only the duty cycles
+    switch (state) {
+    case COMBAT_SEARCH:
+        ControlMouse((combatSide > 0) ? MOUSE_ACTION_ROTATELEFT : MOUSE_ACTION_TURNAROUND);
+        break;
+    case COMBAT_TRACK:
+        ControlArc((combatSide > 0) ? COMBAT_TRACK_RADIUS : -COMBAT_TRACK_RADIUS);
+        break;
+    case COMBAT_CHARGE:
+    case COMBAT_PUSH:
+        if (combatState != COMBAT_CHARGE && combatState != COMBAT_PUSH) {
+            combatPhase = 0;    // a push starts with a burst
+        }
+        ControlMouse(MOUSE_ACTION_FORWARD);
+        Drive(state);       // the registers change now, not in the next control period
+        break;
+    case COMBAT_EVADE:
+        // away from the hit; the search then turns towards it
+        ControlArc((combatSide > 0) ? -COMBAT_EVADE_RADIUS : COMBAT_EVADE_RADIUS);
+        break;
+    case COMBAT_OFF:
+        ControlMouse(MOUSE_ACTION_STOP);
+        break;
+    }
+    combatState = state;
+}
+
+
+// start fighting; the motors are commanded by CombatStep() from now on
+void CombatStart(void)
+{
+    InputEvent event;
+
+    MotionClear();
+    DisableInterrupts;
+    combatSide = 1;
+    combatTouch = 0;
+    combatTimer = 0;
+    while (InputGetEvent(&event)) {
+        // drop the changes from before the bout
+    }
+    Enter(COMBAT_SEARCH);
+    EnableInterrupts;
+}
+
+
+// one input period of the state machine; called by TaskInput() after the
+// inputs have been debounced. It is the only reader of the input events
+// in the combat mode.
+void CombatStep(void)
+{
+    InputEvent event;
+    byte levels, front, rear, ir;
+    CombatState next;
+    signed char side;
+
+    if (combatState == COMBAT_OFF) {
+        return;
+    }
+    while (InputGetEvent(&event)) {
+        // input.c has stamped the edge for 'latency.c'; the levels tell the rest
+    }
+    if (batteryLow) {
+        Enter(COMBAT_OFF);
+        return;
+    }
+
+    levels = inputLevels;
+    front = levels & FRONT;
+    rear = levels & REAR;
+    ir = levels & IR;
+    next = combatState;
+    side = combatSide;
+
+    if (front != 0) {
+        next = COMBAT_PUSH;
+        if (front != FRONT) {
+            side = (front & INPUT_TOUCH_FRONT_LEFT) ? 1 : -1;
+        }
+    }
+    else if (rear != 0 || ((wheelState[MOTOR_LEFT] | wheelState[MOTOR_RIGHT]) & WHEEL_PUSHED)) {
+        next = COMBAT_EVADE;
+        combatTimer = COMBAT_EVADE_TIME;
+        if (rear != 0 && rear != REAR) {
+            side = (rear & INPUT_TOUCH_REAR_LEFT) ? 1 : -1;
+        }
+    }
+    else if (combatState == COMBAT_EVADE && combatTimer != 0) {
+        combatTimer--;      // get away first, whatever is seen
+    }
+    else if (ir == IR) {
+        next = COMBAT_CHARGE;
+    }
+    else if (ir != 0) {
+        next = COMBAT_TRACK;
+        side = (ir & INPUT_IR_FRONT_LEFT) ? 1 : -1;
+    }
+    else {
+        next = COMBAT_SEARCH;
+    }
+
+    if (next != combatState || side != combatSide || front != combatTouch) {
+        combatSide = side;
+        combatTouch = front;
+        Enter(next);
+    }
+}
+
+
+// duty cycles of a charge or a push; called by TaskControl() instead of
+// ControlSpeed() in every control period of either
+void CombatDrive(void)
+{
+    Drive(combatState);
+    if (combatState == COMBAT_PUSH && ++combatPhase >= COMBAT_BURST + COMBAT_REST) {
+        combatPhase = 0;
+    }
+}
+
+
+// report the latencies of the reactions on the SCI, with their bound
+void CombatReport(void)
+{
+    LatencyReportMode(MOUSE_MODE_COMBAT, "Combat  ");
+    SCISendStr("bound ");
+    SCISendDec(INPUT_DEBOUNCE * inputPeriod);
+    SCISendStr(" ms\r\n");
+}
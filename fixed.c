@@ -0,0 +1,321 @@
+///
+/// @file       fixed.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements fixed-point arithmetic in Q8.8 and Q16.16 formats
+///             and table-based trigonometry, so that the firmware needs no
+///             floating-point runtime.
+///
+/// @remarks    All operations saturate instead of wrapping. Angles are
+///             binary angles (see Angle in "mouse.h"); sin/cos and atan2
+///             interpolate linearly in quarter-wave and octant tables.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+/// sin(i * 90 / 64 degrees) in units of 1/65536; the last entry is 1 - 1/65536
+static const word fixSine[65] = {
+    0, 1608, 3216, 4821, 6424, 8022, 9616, 11204,
+    12785, 14359, 15924, 17479, 19024, 20557, 22078, 23586,
+    25080, 26558, 28020, 29466, 30893, 32303, 33692, 35062,
+    36410, 37736, 39040, 40320, 41576, 42806, 44011, 45190,
+    46341, 47464, 48559, 49624, 50660, 51665, 52639, 53581,
+    54491, 55368, 56212, 57022, 57798, 58538, 59244, 59914,
+    60547, 61145, 61705, 62228, 62714, 63162, 63572, 63944,
+    64277, 64571, 64827, 65043, 65220, 65358, 65457, 65516,
+    65535
+};
+
+/// atan(i / 32) as an Angle
+static const word fixArcTangent[33] = {
+    0, 326, 651, 975, 1297, 1617, 1933, 2246,
+    2555, 2860, 3159, 3453, 3742, 4025, 4302, 4572,
+    4836, 5094, 5344, 5589, 5826, 6058, 6282, 6500,
+    6712, 6917, 7117, 7310, 7498, 7679, 7856, 8026,
+    8192
+};
+
+
+//------------------------------------------------------------------------------
+// Q8.8
+//------------------------------------------------------------------------------
+static Q8_8 Saturate8(long x)
+{
+    if (x > Q8_8_MAX) {
+        return Q8_8_MAX;
+    }
+    if (x < Q8_8_MIN) {
+        return Q8_8_MIN;
+    }
+    return (Q8_8)x;
+}
+
+
+Q8_8 FixAdd8(Q8_8 a, Q8_8 b)
+{
+    return Saturate8((long)a + b);
+}
+
+
+// product rounded to the nearest 1/256
+Q8_8 FixMul8(Q8_8 a, Q8_8 b)
+{
+    return Saturate8(((long)a * b + 0x80) >> 8);
+}
+
+
+// quotient truncated towards zero; division by zero saturates
+Q8_8 FixDiv8(Q8_8 a, Q8_8 b)
+{
+    if (b == 0) {
+        return (a < 0) ? Q8_8_MIN : Q8_8_MAX;
+    }
+    return Saturate8(((long)a << 8) / b);
+}
+
+
+//------------------------------------------------------------------------------
+// Q16.16; the products and quotients need 48 bits, so they are built from
+// 16-bit halves of the magnitudes
+//------------------------------------------------------------------------------
+static Q16_16 Saturate16(dword magnitude, byte negative)
+{
+    if (negative) {
+        return (magnitude > 0x80000000UL) ? Q16_16_MIN : (Q16_16)(0 - magnitude);
+    }
+    return (magnitude > 0x7FFFFFFFUL) ? Q16_16_MAX : (Q16_16)magnitude;
+}
+
+
+static dword Magnitude(Q16_16 x)
+{
+    return (x < 0) ? 0 - (dword)x : (dword)x;
+}
+
+
+Q16_16 FixAdd16(Q16_16 a, Q16_16 b)
+{
+    if (b > 0 && a > Q16_16_MAX - b) {
+        return Q16_16_MAX;
+    }
+    if (b < 0 && a < Q16_16_MIN - b) {
+        return Q16_16_MIN;
+    }
+    return a + b;
+}
+
+
+// product rounded to the nearest 1/65536
+Q16_16 FixMul16(Q16_16 a, Q16_16 b)
+{
+    dword ua = Magnitude(a), ub = Magnitude(b);
+    word ah = (word)(ua >> 16), al = (word)ua;
+    word bh = (word)(ub >> 16), bl = (word)ub;
+    dword high, middle, sum;
+    byte negative = (a < 0) != (b < 0);
+
+    high = (dword)ah * bh;
+    if (high > 0x8000UL) {
+        return negative ? Q16_16_MIN : Q16_16_MAX;
+    }
+    sum = high << 16;
+    middle = (dword)ah * bl;
+    if (sum + middle < sum) {
+        return negative ? Q16_16_MIN : Q16_16_MAX;
+    }
+    sum += middle;
+    middle = (dword)al * bh;
+    if (sum + middle < sum) {
+        return negative ? Q16_16_MIN : Q16_16_MAX;
+    }
+    sum += middle;
+    middle = ((dword)al * bl + 0x8000UL) >> 16;
+    if (sum + middle < sum) {
+        return negative ? Q16_16_MIN : Q16_16_MAX;
+    }
+    return Saturate16(sum + middle, negative);
+}
+
+
+// quotient truncated towards zero; division by zero saturates
+Q16_16 FixDiv16(Q16_16 a, Q16_16 b)
+{
+    dword ua = Magnitude(a), ub = Magnitude(b);
+    dword quotient, remainder;
+    byte negative = (a < 0) != (b < 0);
+    byte i;
+
+    if (ub == 0) {
+        return (a < 0) ? Q16_16_MIN : Q16_16_MAX;
+    }
+    quotient = ua / ub;
+    if (quotient > 0x8000UL) {
+        return negative ? Q16_16_MIN : Q16_16_MAX;
+    }
+    remainder = ua % ub;
+
+    // long division for the 16 fractional bits; 'remainder' stays below
+    // 'ub', but doubling it may carry out of 32 bits
+    for (i = 0; i < 16; i++) {
+        quotient <<= 1;
+        if (remainder & 0x80000000UL) {
+            remainder = (remainder << 1) - ub;
+            quotient |= 1;
+        }
+        else {
+            remainder <<= 1;
+            if (remainder >= ub) {
+                remainder -= ub;
+                quotient |= 1;
+            }
+        }
+    }
+    return Saturate16(quotient, negative);
+}
+
+
+//------------------------------------------------------------------------------
+// Square roots
+//------------------------------------------------------------------------------
+// largest integer whose square is not greater than 'x'
+word FixSqrt(dword x)
+{
+    dword root = 0, bit = 1UL << 30;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (word)root;
+}
+
+
+// square root in Q8.8 to within 1/256; negative arguments give zero
+Q8_8 FixSqrt8(Q8_8 x)
+{
+    return (x > 0) ? (Q8_8)FixSqrt((dword)x << 8) : 0;
+}
+
+
+// square root in Q16.16 truncated to 1/65536; negative arguments give zero.
+// It is the integer root of x * 65536, which needs 48 bits, so the bits of
+// the root are found two bits of the argument at a time: 16 passes over the
+// bits of 'x', then 8 over the zeros below them
+Q16_16 FixSqrt16(Q16_16 x)
+{
+    dword ux = (dword)x, root = 0, remainder = 0, trial;
+    byte i;
+
+    if (x <= 0) {
+        return 0;
+    }
+    for (i = 0; i < 24; i++) {
+        remainder = (remainder << 2) | (ux >> 30);
+        ux <<= 2;
+        trial = (root << 2) | 1;
+        root <<= 1;
+        if (remainder >= trial) {
+            remainder -= trial;
+            root |= 1;
+        }
+    }
+    return (Q16_16)root;
+}
+
+
+//------------------------------------------------------------------------------
+// Trigonometry
+//------------------------------------------------------------------------------
+// sin of 'position' from the start of a quarter turn (0 to 0x4000)
+static Q16_16 QuarterSine(word position)
+{
+    byte i = (byte)(position >> 8);
+    byte f = (byte)position;
+
+    if (f == 0) {
+        return fixSine[i];
+    }
+    return fixSine[i] + (Q16_16)((((dword)(fixSine[i + 1] - fixSine[i])) * f + 0x80) >> 8);
+}
+
+
+Q16_16 FixSin(Angle a)
+{
+    word position = a & 0x3FFF;
+    Q16_16 s;
+
+    if (a & 0x4000) {
+        position = 0x4000 - position;   // second and fourth quarters mirror the first
+    }
+    s = QuarterSine(position);
+    return (a & 0x8000) ? -s : s;
+}
+
+
+Q16_16 FixCos(Angle a)
+{
+    return FixSin((Angle)(a + 0x4000));
+}
+
+
+// angle of the vector (x, y) from the x axis; (0, 0) gives zero
+Angle FixAtan2(long y, long x)
+{
+    dword ux = Magnitude(x), uy = Magnitude(y);
+    dword small, big, ratio;
+    word a;
+    byte i;
+    word f;
+
+    if (ux == 0 && uy == 0) {
+        return 0;
+    }
+    if (uy <= ux) {
+        small = uy;
+        big = ux;
+    }
+    else {
+        small = ux;
+        big = uy;
+    }
+    while (big > 0xFFFFUL) {
+        big >>= 1;
+        small >>= 1;
+    }
+
+    // atan(small / big) in the first octant from the table
+    ratio = (small << 15) / big;
+    i = (byte)(ratio >> 10);
+    f = (word)ratio & 0x3FF;
+    a = fixArcTangent[i];
+    if (f != 0) {
+        a += (word)((((dword)(fixArcTangent[i + 1] - fixArcTangent[i])) * f + 0x200) >> 10);
+    }
+
+    if (uy > ux) {
+        a = 0x4000 - a;     // the second octant mirrors the first
+    }
+    if (x < 0) {
+        a = 0x8000 - a;
+    }
+    if (y < 0) {
+        a = 0 - a;
+    }
+    return (Angle)a;
+}
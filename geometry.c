@@ -0,0 +1,232 @@
+///
+/// @file       geometry.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the geometry of the mouse, i.e., the travel of each
+///             wheel per tachometer pulse and the track width, and their
+///             guided calibration.
+///
+/// @remarks    travelDistance counts the tachometer pulses of both wheels;
+///             GeometryMove(), GeometryTurn() and GeometryArc() give the
+///             count for a straight in mm, an in-place rotation and an arc in
+///             degrees from wheelTick and trackWidth. GeometryCalibrate()
+///             drives GEOMETRY_STRAIGHT mm and rotates GEOMETRY_TURNS times
+///             anticlockwise, and asks over the SCI how far the mouse really
+///             went, how far it drifted to the left, and how far past its
+///             start heading it stopped. Two wheels that cover different
+///             distances per pulse curve a straight of equal counts; the
+///             drift y over the distance d makes the paths of the wheels d -/+
+///             y * track / d. The rotation moves both wheels along a circle
+///             of the track width. The flash cannot be written while the
+///             programme runs from it, so GeometryReport() prints the results
+///             as the '#define' block of 'mouse.h', as 'host/ident' does for
+///             the motor models.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#define PI_NUM      355     // pi = PI_NUM / PI_DEN, to 0.00001%
+#define PI_DEN      113
+
+
+// load the default geometry
+void GeometryInit(void)
+{
+    wheelTick[MOTOR_LEFT] = defaultWheelTickLeft;
+    wheelTick[MOTOR_RIGHT] = defaultWheelTickRight;
+    trackWidth = defaultTrackWidth;
+}
+
+
+// tachometer pulses of 'motor' over 'path' in 0.1 mm
+static dword Pulses(Motor motor, dword path)
+{
+    return (path * 100 + (wheelTick[motor] >> 1)) / wheelTick[motor];
+}
+
+
+// travelDistance for a straight of 'mm'
+int GeometryMove(int mm)
+{
+    dword path;
+
+    if (mm < 0) {
+        mm = -mm;
+    }
+    path = (dword)mm * 10;
+    return (int)(Pulses(MOTOR_LEFT, path) + Pulses(MOTOR_RIGHT, path));
+}
+
+
+// path in 0.1 mm of a wheel 'radius' 0.1 mm from the centre of a turn by 'degrees'
+static dword TurnPath(int degrees, word radius)
+{
+    return ((dword)degrees * radius * PI_NUM + (PI_DEN * 180 / 2)) / (PI_DEN * 180);
+}
+
+
+// travelDistance for rotating in place by 'degrees'
+int GeometryTurn(int degrees)
+{
+    dword path;
+
+    if (degrees < 0) {
+        degrees = -degrees;
+    }
+    path = TurnPath(degrees, trackWidth >> 1);
+    return (int)(Pulses(MOTOR_LEFT, path) + Pulses(MOTOR_RIGHT, path));
+}
+
+
+// travelDistance for turning by 'degrees' along an arc of 'radius' mm;
+// positive radii turn left, so that the left wheel is the inner one
+int GeometryArc(int degrees, int radius)
+{
+    word centre, half = trackWidth >> 1;
+    word inner, outer;
+
+    if (degrees < 0) {
+        degrees = -degrees;
+    }
+    centre = (word)(((radius < 0) ? -radius : radius) * 10);
+    inner = (centre > half) ? centre - half : 0;    // a tighter arc pivots on the inner wheel
+    outer = centre + half;
+    if (radius < 0) {
+        return (int)(Pulses(MOTOR_LEFT, TurnPath(degrees, outer)) + Pulses(MOTOR_RIGHT, TurnPath(degrees, inner)));
+    }
+    return (int)(Pulses(MOTOR_LEFT, TurnPath(degrees, inner)) + Pulses(MOTOR_RIGHT, TurnPath(degrees, outer)));
+}
+
+
+//------------------------------------------------------------------------------
+// Calibration
+//------------------------------------------------------------------------------
+// run the queued motion to its end, and return the pulses that each wheel
+// counted in 'count'
+static void Drive(word count[2])
+{
+    word start[2];
+
+    start[MOTOR_LEFT] = tachCount[MOTOR_LEFT];
+    start[MOTOR_RIGHT] = tachCount[MOTOR_RIGHT];
+    MotionPush(MOTION_STOP, GEOMETRY_SETTLE);   // till the wheels are still
+    while (!MotionIdle()) {
+        LoadIdle(); // wait for the stop to finish
+    }
+    count[MOTOR_LEFT] = tachCount[MOTOR_LEFT] - start[MOTOR_LEFT];
+    count[MOTOR_RIGHT] = tachCount[MOTOR_RIGHT] - start[MOTOR_RIGHT];
+}
+
+
+// ask for a number on the SCI
+static int Ask(char *question)
+{
+    SCISendStr(question);
+    return SCIGetDec();
+}
+
+
+// the travel per pulse of each wheel in um from the straight: 'count'
+// pulses over 'distance' mm with 'drift' mm to the left; 0 if it makes no sense
+static byte Ticks(const word count[2], int distance, int drift, word track, word tick[2])
+{
+    long offset, path;
+    byte i;
+
+    if (distance <= 0 || count[MOTOR_LEFT] == 0 || count[MOTOR_RIGHT] == 0) {
+        return 0;
+    }
+    // the difference of the paths of the wheels is the change of heading
+    // times the track width, and the change of heading 2 * drift / distance
+    offset = (long)drift * track * 100 / distance;      // um
+    for (i = 0; i < 2; i++) {
+        path = (long)distance * 1000 + ((i == MOTOR_LEFT) ? -offset : offset);
+        path = (path + (count[i] >> 1)) / count[i];
+        if (path < GEOMETRY_TICK_MIN || path > GEOMETRY_TICK_MAX) {
+            return 0;
+        }
+        tick[i] = (word)path;
+    }
+    return 1;
+}
+
+
+// the track width in 0.1 mm from the rotation: 'count' pulses over
+// 'degrees', with the travel per pulse 'tick'; 0 if it makes no sense
+static word Track(const word count[2], long degrees, const word tick[2])
+{
+    dword path;
+
+    if (degrees <= 0) {
+        return 0;
+    }
+    // both wheels go round a circle of the track width
+    path = ((dword)count[MOTOR_LEFT] * tick[MOTOR_LEFT] + (dword)count[MOTOR_RIGHT] * tick[MOTOR_RIGHT] + 50) / 100;
+    path = (path * (PI_DEN * 180) + (dword)degrees * PI_NUM / 2) / ((dword)degrees * PI_NUM);
+    if (path < GEOMETRY_TRACK_MIN || path > GEOMETRY_TRACK_MAX) {
+        return 0;
+    }
+    return (word)path;
+}
+
+
+// guided calibration of wheelTick and trackWidth; called from the main loop,
+// as it waits for the motions and for the answers over the SCI
+void GeometryCalibrate(void)
+{
+    word straight[2], rotation[2], tick[2], track;
+    int distance, drift, error;
+    byte i;
+
+    SCISendStr("Put the mouse on a straight mark and press any key\r\n");
+    SCIReceiveChar();
+    MotionPush(MOTION_MOVE, GEOMETRY_STRAIGHT);
+    Drive(straight);
+    distance = Ask("Distance travelled in mm: ");
+    drift = Ask("Drift to the left in mm: ");
+
+    SCISendStr("Mark the heading of the mouse and press any key\r\n");
+    SCIReceiveChar();
+    MotionPush(MOTION_TURN, GEOMETRY_TURNS * 360);
+    Drive(rotation);
+    error = Ask("Degrees past the mark, anticlockwise: ");
+
+    // the drift depends on the track width, and the track width on the
+    // ticks; a second pass settles both
+    track = trackWidth;
+    for (i = 0; i < 2; i++) {
+        if (!Ticks(straight, distance, drift, track, tick)) {
+            SCISendStr("Straight rejected\r\n");
+            return;
+        }
+        track = Track(rotation, (long)GEOMETRY_TURNS * 360 + error, tick);
+        if (track == 0) {
+            SCISendStr("Rotation rejected\r\n");
+            return;
+        }
+    }
+    wheelTick[MOTOR_LEFT] = tick[MOTOR_LEFT];
+    wheelTick[MOTOR_RIGHT] = tick[MOTOR_RIGHT];
+    trackWidth = track;
+    GeometryReport();
+}
+
+
+// report the geometry on the SCI as the '#define' block of 'mouse.h'
+void GeometryReport(void)
+{
+    SCISendStr("#define defaultWheelTickLeft    ");
+    SCISendDec(wheelTick[MOTOR_LEFT]);
+    SCISendStr("\r\n#define defaultWheelTickRight   ");
+    SCISendDec(wheelTick[MOTOR_RIGHT]);
+    SCISendStr("\r\n#define defaultTrackWidth       ");
+    SCISendDec(trackWidth);
+    SCISendNewLine();
+}
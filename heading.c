@@ -0,0 +1,83 @@
+///
+/// @file       heading.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the heading hold, the outer loop of the speed
+///             controller on straight moves.
+///
+/// @remarks    The balance of ControlSpeed() compares the tachometer periods
+///             of a single control period, so the heading drifts away with
+///             every error that it has already corrected. The heading hold
+///             counts the tachometer pulses of both wheels since the straight
+///             began, in the travel per pulse of each wheel from 'geometry.c';
+///             for every pulse that a wheel is ahead, its speed target
+///             is HEADING_GAIN pulses/s below the reference and that of the
+///             other wheel HEADING_GAIN pulses/s above it, up to a share of
+///             the reference, until the counts are even again. The speeds
+///             from WheelCheck() add damping. The targets reach the wheels
+///             through the feed-forward of the motor models, so there is no
+///             heading hold without them. Wall centring changes the heading
+///             on purpose, so the heading hold starts over while
+///             WallCorrection() steers.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static word headingStart[2];        // tachCount at the start of the straight
+static volatile byte headingRestart;    // take headingStart in the next control period
+
+
+// start holding the heading of a new straight; called by ControlMouse(), from
+// the main loop as well as from the ISRs, so the counts are taken by
+// HeadingOffset() in the next control period
+void HeadingReset(void)
+{
+    headingRestart = 1;
+}
+
+
+// speed in pulses/s to take off the left wheel's target and to add to the
+// right wheel's for the reference 'speed'; called by ControlSpeed()
+int HeadingOffset(word speed)
+{
+    long offset;
+    int error, limit;
+    word tick;
+
+    if (headingRestart) {
+        headingStart[MOTOR_LEFT] = tachCount[MOTOR_LEFT];
+        headingStart[MOTOR_RIGHT] = tachCount[MOTOR_RIGHT];
+        headingRestart = 0;
+    }
+    if (speed == 0 || (mouseStatus != MOUSE_STATUS_FORWARD && mouseStatus != MOUSE_STATUS_REVERSE)) {
+        return 0;   // nothing to hold
+    }
+    if (motorModel[MOTOR_LEFT].velocity == 0 || motorModel[MOTOR_RIGHT].velocity == 0) {
+        return 0;   // the balance alone follows the targets too slowly; it would swing
+    }
+
+    // both counts go up in either direction, so the wheel that is ahead turns
+    // the mouse towards the other side either way; the counts are weighed by
+    // the travel per pulse of each wheel, so that a larger wheel stays behind
+    tick = (wheelTick[MOTOR_LEFT] + wheelTick[MOTOR_RIGHT]) >> 1;
+    error = (int)(((long)(word)(tachCount[MOTOR_LEFT] - headingStart[MOTOR_LEFT]) * wheelTick[MOTOR_LEFT]
+                   - (long)(word)(tachCount[MOTOR_RIGHT] - headingStart[MOTOR_RIGHT]) * wheelTick[MOTOR_RIGHT]) / tick);
+    // the difference of the wheel speeds is where the error is going; it
+    // damps the loop, which the integrating balance would otherwise swing
+    offset = (long)error * HEADING_GAIN + ((long)wheelSpeed[MOTOR_LEFT] - (long)wheelSpeed[MOTOR_RIGHT]);
+    limit = (int)(speed >> HEADING_LIMIT);
+    if (offset > limit) {
+        return limit;
+    }
+    else if (offset < -limit) {
+        return -limit;
+    }
+    return (int)offset;
+}
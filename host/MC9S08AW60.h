@@ -0,0 +1,142 @@
+///
+/// @file       MC9S08AW60.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Host replacement for the CodeWarrior peripheral header of the
+///             MC9S08AW60; declares the registers used by the firmware as
+///             plain variables defined in 'hostsim.c'.
+///
+/// @remarks    Only the registers and bits used by the firmware are declared.
+///             Status bits that the firmware polls (ADC conversion complete,
+///             SCI transmit/receive) are mapped to simulator hooks.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _HOST_MC9S08AW60_H
+#define _HOST_MC9S08AW60_H
+
+
+#include <stdint.h>
+
+
+// the widths of the target, where int is 16 bits and long 32; 'mouse.h'
+// gives its fixed-point types the same widths under HOST_TARGET_WIDTHS
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef uint32_t dword;
+#define HOST_TARGET_WIDTHS
+
+
+//------------------------------------------------------------------------------
+//  Interrupt vectors; ISRs are ordinary functions on the host
+//------------------------------------------------------------------------------
+#define VectorNumber_Vkeyboard1
+#define VectorNumber_Vtpm2ovf
+#define VectorNumber_Vtpm2ch0
+#define VectorNumber_Vtpm2ch1
+#define VectorNumber_Vsci2tx
+
+
+//------------------------------------------------------------------------------
+//  Registers
+//------------------------------------------------------------------------------
+typedef union {
+    byte Byte;
+    struct {
+        byte BIT0:1;
+        byte BIT1:1;
+        byte BIT2:1;
+        byte BIT3:1;
+        byte BIT4:1;
+        byte BIT5:1;
+        byte BIT6:1;
+        byte BIT7:1;
+    } Bits;
+} HostReg8;
+
+/// @name Parallel I/O
+//@{
+extern volatile HostReg8 _PTAD, _PTBD, _PTCD, _PTDD;
+extern volatile byte PTAPE, PTADD, PTCDD;
+#define PTAD        _PTAD.Byte
+#define PTAD_PTAD0  _PTAD.Bits.BIT0
+#define PTAD_PTAD1  _PTAD.Bits.BIT1
+#define PTAD_PTAD2  _PTAD.Bits.BIT2
+#define PTAD_PTAD3  _PTAD.Bits.BIT3
+#define PTAD_PTAD4  _PTAD.Bits.BIT4
+#define PTAD_PTAD5  _PTAD.Bits.BIT5
+#define PTAD_PTAD6  _PTAD.Bits.BIT6
+#define PTAD_PTAD7  _PTAD.Bits.BIT7
+#define PTBD        _PTBD.Byte
+#define PTBD_PTBD0  _PTBD.Bits.BIT0
+#define PTBD_PTBD1  _PTBD.Bits.BIT1
+#define PTBD_PTBD2  _PTBD.Bits.BIT2
+#define PTBD_PTBD3  _PTBD.Bits.BIT3
+#define PTCD        _PTCD.Byte
+#define PTCD_PTCD2  _PTCD.Bits.BIT2
+#define PTCD_PTCD4  _PTCD.Bits.BIT4
+#define PTCD_PTCD6  _PTCD.Bits.BIT6
+#define PTDD        _PTDD.Byte
+#define PTDD_PTDD2  _PTDD.Bits.BIT2
+#define PTDD_PTDD3  _PTDD.Bits.BIT3
+//@}
+
+/// @name System control and clock generation
+//@{
+extern volatile byte SOPT, ICGC1, ICGC2;
+extern volatile HostReg8 _ICGS1;
+#define ICGS1           _ICGS1.Byte
+#define ICGS1_LOCK      _ICGS1.Bits.BIT3
+//@}
+
+/// @name Keyboard interrupt
+//@{
+extern volatile HostReg8 _KBI1SC;
+#define KBI1SC          _KBI1SC.Byte
+#define KBI1SC_KBACK    _KBI1SC.Bits.BIT2
+//@}
+
+/// @name Timer/PWM modules
+//@{
+extern volatile HostReg8 _TPM1SC, _TPM2SC, _TPM2C0SC, _TPM2C1SC;
+extern volatile byte TPM1C2SC, TPM1C3SC, TPM1C4SC, TPM1C5SC;
+extern volatile word TPM1MOD, TPM1C2V, TPM1C3V, TPM1C4V, TPM1C5V;
+extern volatile word TPM2MOD, TPM2CNT, TPM2C0V, TPM2C1V;
+#define TPM1SC          _TPM1SC.Byte
+#define TPM1SC_TOF      _TPM1SC.Bits.BIT7
+#define TPM2SC          _TPM2SC.Byte
+#define TPM2SC_TOF      _TPM2SC.Bits.BIT7
+#define TPM2C0SC        _TPM2C0SC.Byte
+#define TPM2C0SC_CH0F   _TPM2C0SC.Bits.BIT7
+#define TPM2C1SC        _TPM2C1SC.Byte
+#define TPM2C1SC_CH1F   _TPM2C1SC.Bits.BIT7
+//@}
+
+/// @name Analog-to-digital converter
+//@{
+extern volatile byte ADC1SC1, ADC1CFG, APCTL1, ADC1RL, ADC1RH;
+#define ADC1SC1_COCO    HostADCComplete()
+byte HostADCComplete(void);
+//@}
+
+/// @name Serial communication interface
+//@{
+extern volatile HostReg8 _SCI2C2;
+extern volatile byte SCI2S1;
+extern volatile word SCI2BD;
+extern volatile int SCI2D;  ///< -1 when no character is pending
+#define SCI2C2          _SCI2C2.Byte
+#define SCI2C2_TIE      _SCI2C2.Bits.BIT7
+#define SCI2S1_TDRE     HostSCITransmitReady()
+#define SCI2S1_RDRF     HostSCIReceiveReady()
+byte HostSCITransmitReady(void);
+byte HostSCIReceiveReady(void);
+//@}
+
+
+#endif  // _HOST_MC9S08AW60_H
@@ -0,0 +1,239 @@
+///
+/// @file       fixbench.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Checks the accuracy of 'fixed.c' against double precision and
+///             times it against the same operations in double.
+///
+/// @remarks    Every function is run on random arguments (plus the edge
+///             cases that saturate) and its worst error is compared with the
+///             bound it promises, in units of its last bit; the tool exits
+///             with status 1 if any bound is broken. The timings are host
+///             timings and only show the relative cost; the cycles on the
+///             target come from 's08/cycles.py'.
+///             Usage: fixbench [-n samples]
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#define MAIN_PROGRAM    // this tool owns the firmware globals declared in "mouse.h"
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mouse.h"
+
+
+#define Q8      256.0
+#define Q16     65536.0
+#define TURN    (2.0 * 3.14159265358979323846)
+
+
+typedef struct {
+    const char *name;
+    double bound;       ///< promised worst error in units of the last bit
+    double worst;       ///< worst error seen
+    long failures;
+} Check;
+
+// the bounds follow from the formats: 1/2 for a rounded result, 1 for a
+// truncated one; the table functions add the error of linear interpolation,
+// h^2/8 times the largest second derivative, to that of their entries
+static Check checks[] = {
+    { "FixAdd8", 0.0 },         // exact, or saturated
+    { "FixMul8", 0.5 },         // rounded
+    { "FixDiv8", 1.0 },         // truncated
+    { "FixAdd16", 0.0 },
+    { "FixMul16", 0.5 },
+    { "FixDiv16", 1.0 },
+    { "FixSqrt8", 1.0 },
+    { "FixSqrt16", 1.0 },
+    { "FixSin", 6.5 },          // 4.93 interpolating at h = 90/64 degrees, 1 in the
+    { "FixCos", 6.5 },          // last entry, 0.5 from rounding; 1.0e-4
+    { "FixAtan2", 2.8 }         // 0.83 interpolating at h = 1/32, 0.5 in the entries,
+                                // 0.5 from rounding, 3 * 0.32 from the 15-bit ratio
+                                // of 16-bit operands; 0.015 degrees
+};
+
+enum { ADD8, MUL8, DIV8, ADD16, MUL16, DIV16, SQRT8, SQRT16, SIN, COS, ATAN2 };
+
+
+static unsigned long seed = 12345;
+
+// 32 random bits
+static unsigned long Random(void)
+{
+    seed = seed * 1103515245UL + 12345UL;
+    return (seed >> 16 & 0xFFFF) | ((seed * 69069UL) & 0xFFFF0000UL);
+}
+
+
+// a value of 'bits' random bits, uniformly spread over their magnitudes
+static long RandomValue(int bits, int sign)
+{
+    int width = 1 + (int)(Random() % bits);
+    unsigned long mask = (width == 32) ? 0xFFFFFFFFUL : (1UL << width) - 1;
+    long v = (long)(Random() & mask);
+
+    if (width < 32 && (Random() & 1) && sign) {
+        v = -v;
+    }
+    return (width == 32) ? (long)(int)v : v;
+}
+
+
+static double Clamp(double x, double lo, double hi)
+{
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+
+static void Compare(int which, double got, double expected)
+{
+    double error = fabs(got - expected);
+
+    if (error > checks[which].worst) {
+        checks[which].worst = error;
+    }
+    if (error > checks[which].bound + 1e-9) {
+        if (checks[which].failures++ < 3) {
+            printf("  %s: got %.6f, expected %.6f\n", checks[which].name, got, expected);
+        }
+    }
+}
+
+
+static void CheckQ8(Q8_8 a, Q8_8 b)
+{
+    double x = a / Q8, y = b / Q8, lo = Q8_8_MIN / Q8, hi = Q8_8_MAX / Q8;
+
+    Compare(ADD8, FixAdd8(a, b), Q8 * Clamp(x + y, lo, hi));
+    Compare(MUL8, FixMul8(a, b), Q8 * Clamp(x * y, lo, hi));
+    if (b != 0) {
+        Compare(DIV8, FixDiv8(a, b), Q8 * Clamp(x / y, lo, hi));
+    }
+    if (a >= 0) {
+        Compare(SQRT8, FixSqrt8(a), Q8 * sqrt(x));
+    }
+}
+
+
+static void CheckQ16(Q16_16 a, Q16_16 b)
+{
+    double x = a / Q16, y = b / Q16, lo = Q16_16_MIN / Q16, hi = Q16_16_MAX / Q16;
+
+    Compare(ADD16, FixAdd16(a, b), Q16 * Clamp(x + y, lo, hi));
+    Compare(MUL16, FixMul16(a, b), Q16 * Clamp(x * y, lo, hi));
+    if (b != 0) {
+        Compare(DIV16, FixDiv16(a, b), Q16 * Clamp(x / y, lo, hi));
+    }
+    if (a >= 0) {
+        Compare(SQRT16, FixSqrt16(a), Q16 * sqrt(x));
+    }
+}
+
+
+static void CheckAngles(Angle a, long y, long x)
+{
+    double expected;
+
+    Compare(SIN, FixSin(a), Q16 * sin(a * TURN / 65536.0));
+    Compare(COS, FixCos(a), Q16 * cos(a * TURN / 65536.0));
+    if (x != 0 || y != 0) {
+        // compare as the shorter way round the circle
+        expected = fmod(atan2((double)y, (double)x) * 65536.0 / TURN + 65536.0, 65536.0);
+        expected = fmod(expected - FixAtan2(y, x) + 98304.0, 65536.0) - 32768.0;
+        Compare(ATAN2, 0.0, expected);
+    }
+}
+
+
+// seconds per call of each form of a multiply-accumulate loop
+static void Time(long samples)
+{
+    static Q16_16 fa[1024], fb[1024];
+    static double da[1024], db[1024];
+    volatile Q16_16 fs = 0;
+    volatile double ds = 0.0;
+    clock_t start;
+    double fixTime, doubleTime;
+    long n;
+    int i;
+
+    for (i = 0; i < 1024; i++) {
+        fa[i] = RandomValue(20, 1);
+        fb[i] = RandomValue(20, 1) | 1;
+        da[i] = fa[i] / Q16;
+        db[i] = fb[i] / Q16;
+    }
+
+    printf("\n%-10s %12s %12s\n", "op", "fixed ns", "double ns");
+#define TIME(label, fixExpr, doubleExpr) \
+    start = clock(); \
+    for (n = 0; n < samples; n++) { i = (int)(n & 1023); fs = fixExpr; } \
+    fixTime = (double)(clock() - start) / CLOCKS_PER_SEC; \
+    start = clock(); \
+    for (n = 0; n < samples; n++) { i = (int)(n & 1023); ds = doubleExpr; } \
+    doubleTime = (double)(clock() - start) / CLOCKS_PER_SEC; \
+    printf("%-10s %12.2f %12.2f\n", label, fixTime * 1e9 / samples, doubleTime * 1e9 / samples);
+
+    TIME("mul", FixMul16(fa[i], fb[i]), da[i] * db[i]);
+    TIME("div", FixDiv16(fa[i], fb[i]), da[i] / db[i]);
+    TIME("sqrt", FixSqrt16(fa[i] & 0x7FFFFFFF), sqrt(fabs(da[i])));
+    TIME("sin", FixSin((Angle)fa[i]), sin(da[i]));
+    TIME("atan2", FixAtan2(fa[i], fb[i]), atan2(da[i], db[i]));
+#undef TIME
+    (void)fs;
+    (void)ds;
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const long edges[] = { 0, 1, -1, 0x7FFF, -0x8000, 0x10000, -0x10000,
+                                  0x7FFFFFFF, -0x7FFFFFFF - 1, 0x12345678, -0x12345678,
+                                  0x1FFFF, -0x1FFFF };     // with 0x7FFFFFFF: the last carry of FixMul16()
+    long samples = 1000000, n;
+    int i, j, failed = 0;
+    size_t e, f;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            samples = atol(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n samples]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (e = 0; e < sizeof(edges) / sizeof(edges[0]); e++) {
+        for (f = 0; f < sizeof(edges) / sizeof(edges[0]); f++) {
+            CheckQ8((Q8_8)Clamp(edges[e], Q8_8_MIN, Q8_8_MAX), (Q8_8)Clamp(edges[f], Q8_8_MIN, Q8_8_MAX));
+            CheckQ16(edges[e], edges[f]);
+            CheckAngles((Angle)edges[e], edges[e], edges[f]);
+        }
+    }
+    for (n = 0; n < samples; n++) {
+        CheckQ8((Q8_8)RandomValue(16, 1), (Q8_8)RandomValue(16, 1));
+        CheckQ16(RandomValue(32, 1), RandomValue(32, 1));
+        CheckAngles((Angle)Random(), RandomValue(32, 1), RandomValue(32, 1));
+    }
+
+    printf("%-10s %10s %10s %10s\n", "function", "bound", "worst", "failures");
+    for (j = 0; j < (int)(sizeof(checks) / sizeof(checks[0])); j++) {
+        printf("%-10s %10.3f %10.3f %10ld\n", checks[j].name, checks[j].bound,
+               checks[j].worst, checks[j].failures);
+        failed |= checks[j].failures != 0;
+    }
+
+    Time(samples);
+    return failed;
+}
@@ -0,0 +1,27 @@
+///
+/// @file       hidef.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Host replacement for the CodeWarrior 'hidef.h' used when the
+///             firmware sources are compiled into the host simulator.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _HOST_HIDEF_H
+#define _HOST_HIDEF_H
+
+
+/// The simulator calls ISRs itself between steps, so interrupt masking is a no-op.
+#define EnableInterrupts
+#define DisableInterrupts
+
+/// ISRs are ordinary functions on the host.
+#define interrupt
+
+
+#endif  // _HOST_HIDEF_H
@@ -0,0 +1,304 @@
+///
+/// @file       hostsim.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the host simulator: register storage, a first-order
+///             model of each motor, tachometer pulse generation and the TPM2
+///             timer that drives the firmware ISRs.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#define MAIN_PROGRAM    // the simulator owns the firmware globals declared in "mouse.h"
+
+
+#include <math.h>
+#include <string.h>
+#include "hostsim.h"
+
+
+//------------------------------------------------------------------------------
+//  Registers
+//------------------------------------------------------------------------------
+volatile HostReg8 _PTAD, _PTBD, _PTCD, _PTDD;
+volatile byte PTAPE, PTADD, PTCDD;
+volatile byte SOPT, ICGC1, ICGC2;
+volatile HostReg8 _ICGS1;
+volatile HostReg8 _KBI1SC;
+volatile HostReg8 _TPM1SC, _TPM2SC, _TPM2C0SC, _TPM2C1SC;
+volatile byte TPM1C2SC, TPM1C3SC, TPM1C4SC, TPM1C5SC;
+volatile word TPM1MOD, TPM1C2V, TPM1C3V, TPM1C4V, TPM1C5V;
+volatile word TPM2MOD, TPM2CNT, TPM2C0V, TPM2C1V;
+volatile byte ADC1SC1, ADC1CFG, APCTL1, ADC1RL, ADC1RH;
+volatile HostReg8 _SCI2C2;
+volatile byte SCI2S1;
+volatile word SCI2BD;
+volatile int SCI2D;
+
+
+//------------------------------------------------------------------------------
+//  Simulator state
+//------------------------------------------------------------------------------
+const HostPlant hostDefaultPlant = {
+    {
+        { 740.0, 0.080, 0.06 },     // left motor
+        { 690.0, 0.090, 0.07 }      // right motor
+    },
+    1.0
+};
+
+static HostPlant plant;
+static double simTime;
+static double speed[2];     // signed wheel speed in pulses/s
+static double phase[2];     // fraction of the next tachometer pulse travelled
+static long pulses[2];
+static double tpm2Count;    // TPM2 counts since reset, in prescaled clock ticks
+static byte adc[32];
+static byte (*adcReader)(byte ch);
+static void (*sciSink)(byte ch);
+
+
+// fraction of a PWM period for which an edge-aligned, high-true channel is high
+static double HighFraction(word value)
+{
+    double period = (double)TPM1MOD + 1.0;
+
+    if ((double)value >= period) {
+        return 1.0;
+    }
+    return (double)value / period;
+}
+
+
+// advance one motor; IN_A low and IN_B high drives it forward
+static void StepMotor(Motor motor, word inA, word inB)
+{
+    const HostMotor *m = &plant.motor[motor];
+    double drive, target;
+
+    if (inA == LOW_WORD && inB == LOW_WORD) {
+        // both low-side switches on: short-circuit braking
+        speed[motor] -= speed[motor] * HOST_STEP / (m->tau / 4.0);
+        return;
+    }
+
+    drive = (HighFraction(inB) - HighFraction(inA)) * plant.battery;
+    if (fabs(drive) <= m->friction) {
+        target = 0.0;
+    }
+    else {
+        target = (drive > 0.0 ? drive - m->friction : drive + m->friction) * m->gain;
+    }
+    speed[motor] += (target - speed[motor]) * HOST_STEP / m->tau;
+}
+
+
+// TPM2 counter value at a given number of prescaled clock ticks since reset
+static word TPM2Counter(double count)
+{
+    double modulus = (TPM2MOD == 0) ? 65536.0 : (double)TPM2MOD + 1.0;
+
+    return (word)fmod(floor(count), modulus);
+}
+
+
+// generate the input capture for a tachometer pulse; the ISR runs at once
+static void CapturePulse(Motor motor, double count)
+{
+    TPM2CNT = TPM2Counter(count);
+    if (motor == MOTOR_LEFT) {
+        TPM2C0V = TPM2Counter(count);
+        TPM2C0SC_CH0F = 1;
+        if (TPM2C0SC & 0x40) {
+            intTPM2CH0();
+        }
+    }
+    else {
+        TPM2C1V = TPM2Counter(count);
+        TPM2C1SC_CH1F = 1;
+        if (TPM2C1SC & 0x40) {
+            intTPM2CH1();
+        }
+    }
+}
+
+
+void HostReset(const HostPlant *p)
+{
+    plant = *p;
+    simTime = 0.0;
+    memset(speed, 0, sizeof(speed));
+    memset(phase, 0, sizeof(phase));
+    memset(pulses, 0, sizeof(pulses));
+    memset(adc, 0, sizeof(adc));
+    tpm2Count = 0.0;
+
+    PTAD = PTBD = PTCD = 0;
+    PTDD = 0x0C;        // SW3 and SW4 released
+    KBI1SC = TPM1SC = TPM2SC = TPM2C0SC = TPM2C1SC = 0;
+    TPM1MOD = TPM2MOD = TPM2CNT = 0;
+    TPM1C2V = TPM1C3V = TPM1C4V = TPM1C5V = HIGH_WORD;
+    SCI2C2 = 0;
+    SCI2D = -1;
+    ICGS1_LOCK = 1;     // the FLL locks at once
+    adc[batteryChannel] = (byte)(BATTERY_COUNTS(BATTERY_NOMINAL) * plant.battery + 0.5);
+
+    MouseSetup();
+
+    // prime the static capture values of the tachometer ISRs, so that every
+    // run starts from the same state regardless of earlier runs
+    TPM2C0V = TPM2C1V = 0;
+    intTPM2CH0();
+    intTPM2CH1();
+    diffLeft = 0;
+    diffRight = 0;
+}
+
+
+// raise the TPM2 overflows up to a number of prescaled clock ticks since reset
+static void Overflows(double start, double count)
+{
+    double modulus = (TPM2MOD == 0) ? 65536.0 : (double)TPM2MOD + 1.0;
+    double next = (floor(start / modulus) + 1.0) * modulus;
+
+    while (next <= count) {
+        TPM2SC_TOF = 1;
+        TPM2CNT = 0;
+        if (TPM2SC & 0x40) {
+            intTPM2OVF();
+        }
+        next += modulus;
+    }
+}
+
+
+void HostStep(void)
+{
+    double rate, start, due[HOST_PULSES], t;
+    Motor motor[HOST_PULSES];
+    int i, j, n = 0;
+
+    StepMotor(MOTOR_LEFT, TPM1C2V, TPM1C3V);
+    StepMotor(MOTOR_RIGHT, TPM1C4V, TPM1C5V);
+
+    // TPM2 runs only when a clock source is selected (CLKSB:CLKSA != 0)
+    rate = (TPM2SC & 0x18) ? busClock * 1e6 / (double)(1 << (TPM2SC & 0x07)) : 0.0;
+    start = tpm2Count;
+    tpm2Count += rate * HOST_STEP;
+
+    // tachometer pulses, captured at the counter value when they happen
+    for (i = 0; i < 2; i++) {
+        phase[i] += fabs(speed[i]) * HOST_STEP;
+        while (phase[i] >= 1.0) {
+            phase[i] -= 1.0;
+            pulses[i]++;
+            t = tpm2Count - phase[i] / fabs(speed[i]) * rate;
+            if (n < HOST_PULSES) {
+                // insert in time order
+                for (j = n++; j > 0 && due[j - 1] > t; j--) {
+                    due[j] = due[j - 1];
+                    motor[j] = motor[j - 1];
+                }
+                due[j] = (t < start) ? start : t;
+                motor[j] = (Motor)i;
+            }
+        }
+    }
+
+    // pulses and timer overflows in the order they happen
+    for (i = 0; i < n; i++) {
+        if (rate > 0.0) {
+            Overflows(start, due[i]);
+            start = due[i];
+        }
+        CapturePulse(motor[i], due[i]);
+    }
+    if (rate > 0.0) {
+        Overflows(start, tpm2Count);
+    }
+
+    TPM2CNT = TPM2Counter(tpm2Count);
+    simTime += HOST_STEP;
+
+#ifdef TRACE
+    while (SCI2C2_TIE) {
+        intSCI2TX();
+    }
+#endif
+}
+
+
+double HostTime(void)
+{
+    return simTime;
+}
+
+
+double HostWheelSpeed(Motor motor)
+{
+    return speed[motor];
+}
+
+
+long HostWheelPulses(Motor motor)
+{
+    return pulses[motor];
+}
+
+
+void HostSetPlant(const HostPlant *p)
+{
+    plant = *p;
+}
+
+
+void HostSetADC(byte ch, byte value)
+{
+    adc[ch & 0x1F] = value;
+}
+
+
+void HostSetADCReader(byte (*reader)(byte ch))
+{
+    adcReader = reader;
+}
+
+
+void HostSetSCISink(void (*sink)(byte ch))
+{
+    sciSink = sink;
+}
+
+
+//------------------------------------------------------------------------------
+//  Hooks for polled status bits
+//------------------------------------------------------------------------------
+// conversions complete immediately with the value set by HostSetADC() or
+// returned by the reader
+byte HostADCComplete(void)
+{
+    ADC1RL = adcReader ? adcReader(ADC1SC1 & 0x1F) : adc[ADC1SC1 & 0x1F];
+    return 1;
+}
+
+
+// transmission is immediate; characters written to SCI2D go to the sink
+byte HostSCITransmitReady(void)
+{
+    if (SCI2D >= 0 && sciSink) {
+        sciSink((byte)SCI2D);
+    }
+    SCI2D = -1;
+    return 1;
+}
+
+
+// nothing is ever received on the host
+byte HostSCIReceiveReady(void)
+{
+    return 0;
+}
@@ -0,0 +1,84 @@
+///
+/// @file       hostsim.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Declares the host simulator that runs the firmware control code
+///             against a model of the motors, tachometers and timers.
+///
+/// @remarks    The firmware sources are compiled unchanged with this directory
+///             first on the include path, so that 'hidef.h' and
+///             'MC9S08AW60.h' resolve to the host replacements. The simulator
+///             owns the firmware globals (it defines MAIN_PROGRAM) and calls
+///             the ISRs from 'isr.c' when the modelled timers fire.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _HOST_SIM_H
+#define _HOST_SIM_H
+
+
+#include "../mouse.h"
+
+
+/// Simulation step in seconds.
+#define HOST_STEP   100e-6
+
+/// Most tachometer pulses simulated in a step; more are counted but not captured.
+#define HOST_PULSES 8
+
+
+/// Model of one motor with its tachometer.
+typedef struct {
+    double gain;        ///< tachometer pulses per second at 100% duty cycle and nominal battery voltage
+    double tau;         ///< mechanical time constant in s
+    double friction;    ///< duty cycle (0..1) lost to static friction
+} HostMotor;
+
+/// Model of the whole mouse.
+typedef struct {
+    HostMotor motor[2]; ///< indexed by Motor
+    double battery;     ///< battery voltage relative to its nominal value
+} HostPlant;
+
+
+/// Default plant: slightly mismatched motors on a fresh battery.
+extern const HostPlant hostDefaultPlant;
+
+
+/// Reset registers and firmware globals, then run MouseSetup().
+void HostReset(const HostPlant *plant);
+
+/// Advance the simulation by HOST_STEP, calling ISRs as the timers fire.
+void HostStep(void);
+
+/// Change the plant without a reset, e.g., to block a wheel.
+void HostSetPlant(const HostPlant *plant);
+
+/// Simulated time since HostReset() in s.
+double HostTime(void);
+
+/// Wheel speed in tachometer pulses per second.
+double HostWheelSpeed(Motor motor);
+
+/// Tachometer pulses counted since HostReset().
+long HostWheelPulses(Motor motor);
+
+/// Set the 8-bit ADC result returned for a channel.
+void HostSetADC(byte ch, byte value);
+
+/// Take ADC results from 'reader' instead of the values set by HostSetADC();
+/// 0 restores them.
+void HostSetADCReader(byte (*reader)(byte ch));
+
+/// Pass every character the firmware sends over the SCI to 'sink'; 0
+/// discards them. With TRACE defined, HostStep() drains the trace stream
+/// through the SCI at once, so that no record is lost.
+void HostSetSCISink(void (*sink)(byte ch));
+
+
+#endif  // _HOST_SIM_H
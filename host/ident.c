@@ -0,0 +1,152 @@
+///
+/// @file       ident.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Identifies the motor models with ModelIdentify() in the host
+///             simulator, and compares speed steps of the controller with
+///             and without their feed-forward.
+///
+/// @remarks    The identified models are checked against the ones of the
+///             simulated plant; the models of the default plant are printed
+///             as the '#define' block of 'mouse.h'. The step test starts from
+///             standstill at one nominal period and changes to another
+///             mid-run, and reports how many control periods both wheels
+///             take to settle within SETTLE_BAND of the new speed.
+///             Usage: ident [-v]
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "hostsim.h"
+
+
+#define SETTLE_BAND     0.05    ///< relative speed error regarded as settled
+#define STEP_TIME       1.0     ///< seconds at each nominal period of the step test
+#define STEP_FROM       4096    ///< nominal period in us before the step
+#define STEP_TO         3072    ///< nominal period in us after the step
+
+
+static int verbose;
+
+
+// run the identification on a plant; 0 if it does not finish
+static int Identify(const HostPlant *plant)
+{
+    HostReset(plant);
+    ModelIdentify();
+    while (modelIdentifying) {
+        HostStep();
+        if (HostTime() > 10.0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+// control periods from 'start' until both wheels stay within SETTLE_BAND of
+// 'target' pulses/s, over 'seconds'
+static int Settle(double start, double seconds, double target)
+{
+    double settled = start;
+    int i;
+
+    while (HostTime() < start + seconds) {
+        HostStep();
+        for (i = 0; i < 2; i++) {
+            if (fabs(HostWheelSpeed((Motor)i) - target) > SETTLE_BAND * target) {
+                settled = HostTime();
+            }
+        }
+    }
+    return (int)ceil((settled - start) * 1000.0 / controlPeriod);
+}
+
+
+// speed steps of the controller on a plant, with the current motor models
+static void StepTest(const HostPlant *plant, const MotorModel *model, int *start, int *change)
+{
+    HostReset(plant);
+    memcpy(motorModel, model, sizeof(motorModel));
+    trimLeft = (model[MOTOR_LEFT].velocity != 0) ? 0 : (int)pwLeft;
+    trimRight = (model[MOTOR_RIGHT].velocity != 0) ? 0 : (int)pwRight;
+    nomSpeed = (int)TPM2_COUNTS(STEP_FROM);
+    travelDistance = 0;
+
+    ControlMouse(MOUSE_ACTION_FORWARD);
+    *start = Settle(HostTime(), STEP_TIME, 1e6 / STEP_FROM);
+    nomSpeed = (int)TPM2_COUNTS(STEP_TO);
+    *change = Settle(HostTime(), STEP_TIME, 1e6 / STEP_TO);
+}
+
+
+static void PrintModel(const char *name, const MotorModel *m)
+{
+    printf("  %-6s friction %3u %%  velocity %6u  accel %6u\n", name, m->friction, m->velocity, m->accel);
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const char *plants[] = { "default plant", "swapped motors", "tired battery" };
+    static const MotorModel none[2];
+    HostPlant plant;
+    MotorModel truth[2], identified[2];
+    int p, i, start, change, startFf, changeFf;
+    double velocity;
+
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "-v") != 0)) {
+        fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+        return 2;
+    }
+    verbose = (argc == 2);
+
+    for (p = 0; p < 3; p++) {
+        plant = hostDefaultPlant;
+        if (p == 1) {
+            plant.motor[MOTOR_LEFT] = hostDefaultPlant.motor[MOTOR_RIGHT];
+            plant.motor[MOTOR_RIGHT] = hostDefaultPlant.motor[MOTOR_LEFT];
+        }
+        if (p == 2) {
+            plant.battery = 0.8;
+        }
+        if (!Identify(&plant)) {
+            fprintf(stderr, "%s: the identification did not finish\n", plants[p]);
+            return 1;
+        }
+        memcpy(identified, motorModel, sizeof(identified));
+
+        // the models of the simulated motors, at the nominal battery voltage
+        for (i = 0; i < 2; i++) {
+            velocity = 100.0 / plant.motor[i].gain;
+            truth[i].friction = (byte)floor(100.0 * plant.motor[i].friction + 0.5);
+            truth[i].velocity = (word)floor(velocity * 65536.0 + 0.5);
+            truth[i].accel = (word)floor(velocity * plant.motor[i].tau * 65536.0 + 0.5);
+        }
+        printf("%s:\n", plants[p]);
+        PrintModel("left", &identified[MOTOR_LEFT]);
+        PrintModel("right", &identified[MOTOR_RIGHT]);
+        if (verbose) {
+            PrintModel("(left)", &truth[MOTOR_LEFT]);
+            PrintModel("(right)", &truth[MOTOR_RIGHT]);
+        }
+
+        StepTest(&plant, none, &start, &change);
+        StepTest(&plant, identified, &startFf, &changeFf);
+        printf("  control periods to settle: start %d, change %d without feed-forward;"
+               " start %d, change %d with it\n", start, change, startFf, changeFf);
+    }
+
+    Identify(&hostDefaultPlant);
+    printf("#define defaultModelFriction    %d\n", (motorModel[0].friction + motorModel[1].friction + 1) / 2);
+    printf("#define defaultModelVelocity    %ld\n", ((long)motorModel[0].velocity + motorModel[1].velocity + 1) / 2);
+    printf("#define defaultModelAccel       %ld\n", ((long)motorModel[0].accel + motorModel[1].accel + 1) / 2);
+    return 0;
+}
@@ -0,0 +1,244 @@
+///
+/// @file       mapreport.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Reports the flash and RAM used by each module from a linker
+///             map, and the RAM left beside data and stack.
+///
+/// @remarks    Reads the OBJECT-ALLOCATION and SECTION-ALLOCATION sections
+///             of a CodeWarrior map, or the areas and global symbols of an
+///             SDCC map ('s08/build.sh'). SDCC maps give no object sizes, so
+///             each symbol is taken to extend to the next one in its area.
+///             Objects are counted as RAM or flash by address (MC9S08AW60:
+///             RAM 0x0070 to 0x086F). Exits with status 1 if data and stack
+///             do not fit in the RAM.
+///             Usage: mapreport [-r ram_bytes] file.map
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define RAM_START       0x0070UL
+#define RAM_END         0x0870UL    ///< exclusive
+#define REG_START       0x1800UL    ///< high page registers, neither RAM nor flash
+#define REG_END         0x1860UL
+#define MAX_MODULES     128
+#define MAX_AREAS       64
+#define MAX_SYMBOLS     2048
+#define NAME_LENGTH     64
+
+
+typedef struct {
+    char name[NAME_LENGTH];
+    unsigned long flash, ram;
+} Module;
+
+typedef struct {
+    char name[NAME_LENGTH];
+    unsigned long addr, size;
+} Area;
+
+typedef struct {
+    unsigned long addr;
+    int module;
+} Symbol;
+
+
+static Module modules[MAX_MODULES];
+static int moduleCount;
+static Area areas[MAX_AREAS];
+static int areaCount;
+static Symbol symbols[MAX_SYMBOLS];
+static int symbolCount;
+static unsigned long stackSize;
+
+
+static int FindModule(const char *name)
+{
+    int i;
+
+    for (i = 0; i < moduleCount; i++) {
+        if (!strcmp(modules[i].name, name)) {
+            return i;
+        }
+    }
+    if (moduleCount == MAX_MODULES) {
+        return MAX_MODULES - 1;     // lump the rest together
+    }
+    strncpy(modules[moduleCount].name, name, NAME_LENGTH - 1);
+    return moduleCount++;
+}
+
+
+static void Count(int module, unsigned long addr, unsigned long size)
+{
+    if (module < 0 || size == 0) {
+        return;
+    }
+    if (addr >= RAM_START && addr < RAM_END) {
+        modules[module].ram += size;
+    }
+    else if (addr < REG_START || addr >= REG_END) {
+        modules[module].flash += size;
+    }
+}
+
+
+// a line of the CodeWarrior OBJECT-ALLOCATION SECTION:
+// name, address (hex), size (hex), size (decimal), references, section
+static int ParseObject(const char *line, unsigned long *addr, unsigned long *size)
+{
+    char name[NAME_LENGTH];
+    unsigned long hexSize, decSize, refs;
+
+    if (sscanf(line, " %63s %lx %lx %lu %lu", name, addr, &hexSize, &decSize, &refs) != 5) {
+        return 0;
+    }
+    *size = decSize;
+    return hexSize == decSize;  // the two sizes agree on real entries
+}
+
+
+static int CompareSymbols(const void *a, const void *b)
+{
+    unsigned long x = ((const Symbol *)a)->addr, y = ((const Symbol *)b)->addr;
+
+    return (x > y) - (x < y);
+}
+
+
+// give each SDCC symbol the bytes up to the next symbol or the end of its area
+static void SizeSymbols(void)
+{
+    int i, a;
+    unsigned long end, next;
+
+    qsort(symbols, symbolCount, sizeof(Symbol), CompareSymbols);
+    for (i = 0; i < symbolCount; i++) {
+        for (a = 0; a < areaCount; a++) {
+            if (symbols[i].addr >= areas[a].addr && symbols[i].addr < areas[a].addr + areas[a].size) {
+                break;
+            }
+        }
+        if (a == areaCount) {
+            continue;   // an absolute symbol, e.g., a register
+        }
+        end = areas[a].addr + areas[a].size;
+        next = (i + 1 < symbolCount && symbols[i + 1].addr < end) ? symbols[i + 1].addr : end;
+        Count(symbols[i].module, symbols[i].addr, next - symbols[i].addr);
+    }
+}
+
+
+static void Parse(FILE *f)
+{
+    char line[512], name[NAME_LENGTH], module[NAME_LENGTH], *p, *q;
+    unsigned long addr, size;
+    int current = -1, objects = 0, sdccSymbols = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        // CodeWarrior
+        if (strstr(line, "OBJECT-ALLOCATION SECTION")) {
+            objects = 1;
+            continue;
+        }
+        if (objects && (p = strstr(line, "MODULE:")) != NULL) {
+            p = strstr(p, "-- ");
+            q = p ? strstr(p + 3, " --") : NULL;
+            if (p && q) {
+                *q = '\0';
+                current = FindModule(p + 3);
+            }
+            continue;
+        }
+        if (objects && current >= 0 && ParseObject(line, &addr, &size)) {
+            Count(current, addr, size);
+            continue;
+        }
+        if (!strncmp(line, ".stack", 6) || !strncmp(line, "SSTACK", 6)) {
+            sscanf(line, "%*s %lu", &stackSize);
+            continue;
+        }
+        if (strstr(line, "*****") && objects && current >= 0) {
+            objects = 0;    // end of the section
+        }
+
+        // SDCC: "NAME  addr  size =  decimal. bytes" and "addr  _symbol  module"
+        if (sscanf(line, "%63s %lx %lx = %lu. bytes", name, &addr, &size, &size) == 4
+            && areaCount < MAX_AREAS) {
+            strcpy(areas[areaCount].name, name);
+            areas[areaCount].addr = addr;
+            areas[areaCount].size = size;
+            areaCount++;
+            sdccSymbols = 0;
+            continue;
+        }
+        if (strstr(line, "Global Defined In Module")) {
+            sdccSymbols = 1;
+            continue;
+        }
+        if (sdccSymbols && sscanf(line, " %lx %63s %63s", &addr, name, module) == 3
+            && isxdigit((unsigned char)line[strspn(line, " ")]) && symbolCount < MAX_SYMBOLS) {
+            symbols[symbolCount].addr = addr;
+            symbols[symbolCount].module = FindModule(module);
+            symbolCount++;
+        }
+    }
+    if (symbolCount > 0) {
+        SizeSymbols();
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned long ram = RAM_END - RAM_START, flash = 0, data = 0;
+    const char *file = NULL;
+    FILE *f;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            ram = strtoul(argv[++i], NULL, 0);
+        }
+        else if (argv[i][0] != '-' && file == NULL) {
+            file = argv[i];
+        }
+        else {
+            fprintf(stderr, "usage: %s [-r ram_bytes] file.map\n", argv[0]);
+            return 2;
+        }
+    }
+    if (file == NULL || (f = fopen(file, "r")) == NULL) {
+        fprintf(stderr, "%s: cannot read the map file\n", argv[0]);
+        return 2;
+    }
+    Parse(f);
+    fclose(f);
+
+    printf("%-32s %8s %8s\n", "module", "flash", "RAM");
+    for (i = 0; i < moduleCount; i++) {
+        if (modules[i].flash || modules[i].ram) {
+            printf("%-32s %8lu %8lu\n", modules[i].name, modules[i].flash, modules[i].ram);
+        }
+        flash += modules[i].flash;
+        data += modules[i].ram;
+    }
+    printf("%-32s %8lu %8lu\n", "total", flash, data);
+
+    printf("\nRAM %lu bytes: data %lu, stack %lu, free %ld\n",
+           ram, data, stackSize, (long)ram - (long)data - (long)stackSize);
+    if (stackSize == 0) {
+        printf("(no stack section in the map; the stack takes what is free)\n");
+    }
+    return data + stackSize > ram;
+}
@@ -0,0 +1,223 @@
+///
+/// @file       mazebench.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Runs the maze solver of 'maze.c' over a corpus of maze files
+///             in parallel and reports its cost per maze; this is the
+///             regression benchmark for solver changes.
+///
+/// @remarks    For each maze, the mouse searches from the start to the centre
+///             and back, seeing only the walls of the cells it enters; with
+///             '-e' the way back is planned by MazeExploreStep(). Reported
+///             are the cells explored, the moves made, the search distance
+///             and time, the shortest path through explored cells against the
+///             true shortest path, the cells expanded by the flood fill (a
+///             deterministic measure of run time), the host run time and the
+///             peak queue length. The search time assumes a constant
+///             SEARCH_SPEED with smooth turns, and a stop, an in-place
+///             half turn and a start for every turnaround.
+///             Usage: mazebench [-e] [-j workers] [-g count] [-w dir] [files ...]
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#define MAIN_PROGRAM    // this tool owns the firmware globals declared in "mouse.h"
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mazefile.h"
+#include "pool.h"
+
+
+#define MAX_MOVES   4096    ///< give up a run after this many moves
+#define SEARCH_SPEED    (PATH_TURN90_SPEED * PATH_SPEED_UNIT)  ///< speed of the search run in mm/s
+#define PIVOT_TIME  0.25    ///< time of an in-place 90 degree turn in s
+
+
+typedef struct {
+    char name[64];
+    byte walls[MAZE_CELLS];
+} Maze;
+
+typedef struct {
+    int explored;       ///< cells visited
+    int moves;          ///< moves in the search run and the return to the start
+    int turnarounds;    ///< moves back into the cell just left
+    double seconds;     ///< estimated time of the search run and the return
+    int path;           ///< path length to the centre through explored cells
+    int optimal;        ///< true shortest path length
+    long updates;       ///< cells expanded by MazeFlood()
+    int queuePeak;      ///< peak length of the flood-fill queue
+    double micros;      ///< host run time in us
+} Outcome;
+
+
+static int explore;     // plan the way back with MazeExploreStep()
+
+
+// drive the solver towards the centre (toStart == 0) or back to the start,
+// and count the turnarounds on the way
+static int Search(const byte walls[MAZE_CELLS], byte toStart, int *turnarounds)
+{
+    int moves = 0;
+    byte heading;
+
+    while (moves < MAX_MOVES) {
+        if (toStart ? (mazeCell == MAZE_START) : MazeIsGoal(mazeCell)) {
+            MazeSetWalls(mazeCell, walls[mazeCell]);
+            break;
+        }
+        heading = mazeHeading;
+        if (toStart && explore) {
+            MazeExploreStep(walls[mazeCell]);
+        }
+        else {
+            MazeStep(walls[mazeCell], toStart);
+        }
+        if (mazeHeading == MAZE_OPPOSITE(heading)) {
+            (*turnarounds)++;
+        }
+        moves++;
+    }
+    return moves;
+}
+
+
+static void Run(long index, void *result, void *context)
+{
+    const Maze *maze = (const Maze *)context + index;
+    Outcome *o = (Outcome *)result;
+    struct timespec t0, t1;
+    word i;
+
+    mazeCellUpdates = 0;
+    mazeQueuePeak = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    MazeInit();
+    o->turnarounds = 0;
+    o->moves = Search(maze->walls, 0, &o->turnarounds);
+    o->moves += Search(maze->walls, 1, &o->turnarounds);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    // a turnaround stops and starts again, which takes SEARCH_SPEED /
+    // PATH_ACCEL longer than driving through, and pivots by 180 degrees
+    o->seconds = (double)o->moves * PATH_CELL_MM / SEARCH_SPEED
+        + o->turnarounds * ((double)SEARCH_SPEED / PATH_ACCEL + 2.0 * PIVOT_TIME);
+
+    // the fast run may only use cells that have been explored
+    o->explored = 0;
+    for (i = 0; i < MAZE_CELLS; i++) {
+        if (mazeMap[i] & MAZE_VISITED) {
+            o->explored++;
+        }
+        else {
+            mazeMap[i] |= MAZE_WALLS;
+        }
+    }
+    MazeFlood(0);
+    o->path = (mazeDist[MAZE_START] == MAZE_UNREACHED) ? -1 : mazeDist[MAZE_START];
+    o->optimal = MazeFileShortest(maze->walls);
+    o->updates = (long)mazeCellUpdates;
+    o->queuePeak = mazeQueuePeak;
+    o->micros = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+}
+
+
+int main(int argc, char *argv[])
+{
+    Maze *mazes;
+    Outcome *results;
+    const char *dir = NULL;
+    char path[512];
+    FILE *out;
+    int workers = 0, generate = 0, count = 0, i, peak = 0, optimal = 0;
+    long moves = 0, updates = 0;
+    double seconds = 0.0;
+
+    mazes = malloc(sizeof(Maze) * (size_t)argc);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-e") == 0) {
+            explore = 1;
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            generate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        }
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-e] [-j workers] [-g count] [-w dir] [files ...]\n", argv[0]);
+            return 2;
+        }
+        else {
+            if (MazeFileLoad(argv[i], mazes[count].walls) != 0) {
+                fprintf(stderr, "%s: cannot read maze\n", argv[i]);
+                return 1;
+            }
+            snprintf(mazes[count].name, sizeof(mazes[count].name), "%s", argv[i]);
+            count++;
+        }
+    }
+
+    // generated mazes are appended to the files given on the command line
+    mazes = realloc(mazes, sizeof(Maze) * (size_t)(count + generate + 1));
+    results = malloc(sizeof(Outcome) * (size_t)(count + generate + 1));
+    if (mazes == NULL || results == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (i = 1; i <= generate; i++, count++) {
+        MazeFileGenerate((unsigned long)i, mazes[count].walls);
+        snprintf(mazes[count].name, sizeof(mazes[count].name), "random%03d", i);
+        if (dir != NULL) {
+            snprintf(path, sizeof(path), "%s/%s.txt", dir, mazes[count].name);
+            out = fopen(path, "w");
+            if (out != NULL) {
+                MazeFilePrint(out, mazes[count].walls);
+                fclose(out);
+            }
+            snprintf(path, sizeof(path), "%s/%s.maz", dir, mazes[count].name);
+            MazeFileSaveBinary(path, mazes[count].walls);
+        }
+    }
+
+    if (PoolRun(count, Run, mazes, results, sizeof(Outcome), workers) != 0) {
+        fprintf(stderr, "some workers failed\n");
+        return 1;
+    }
+
+    printf("%-24s %8s %6s %8s %8s %5s %7s %8s %6s %9s\n", "maze", "explored", "moves",
+           "dist(m)", "time(s)", "path", "optimal", "updates", "queue", "host(us)");
+    for (i = 0; i < count; i++) {
+        printf("%-24s %8d %6d %8.1f %8.1f %5d %7d %8ld %6d %9.1f\n", mazes[i].name,
+               results[i].explored, results[i].moves, results[i].moves * PATH_CELL_MM / 1000.0,
+               results[i].seconds, results[i].path, results[i].optimal,
+               results[i].updates, results[i].queuePeak, results[i].micros);
+        moves += results[i].moves;
+        seconds += results[i].seconds;
+        updates += results[i].updates;
+        if (results[i].path == results[i].optimal) {
+            optimal++;
+        }
+        if (results[i].queuePeak > peak) {
+            peak = results[i].queuePeak;
+        }
+    }
+    printf("total: %d mazes, %ld moves, %.1f m, %.1f s, %d shortest paths found, %ld cell updates\n",
+           count, moves, moves * PATH_CELL_MM / 1000.0, seconds, optimal, updates);
+    printf("solver RAM: %u bytes static (map, distances, queue), peak queue %d cells\n",
+           (unsigned)(sizeof(mazeMap) + sizeof(mazeDist) + MAZE_CELLS + 2), peak);
+
+    free(results);
+    free(mazes);
+    return 0;
+}
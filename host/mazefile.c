@@ -0,0 +1,262 @@
+///
+/// @file       mazefile.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements reading, writing and generation of maze files.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include <string.h>
+#include "mazefile.h"
+
+
+#define TEXT_LINES  (2 * MAZE_SIZE + 1)
+#define TEXT_WIDTH  (4 * MAZE_SIZE + 1)
+
+
+static const int dx[4] = { 0, 1, 0, -1 };
+static const int dy[4] = { 1, 0, -1, 0 };
+
+
+// add a wall on both sides
+static void AddWall(byte walls[MAZE_CELLS], int x, int y, int dir)
+{
+    int nx = x + dx[dir], ny = y + dy[dir];
+
+    walls[MAZE_CELL(x, y)] |= MAZE_WALL(dir);
+    if (nx >= 0 && nx < MAZE_SIZE && ny >= 0 && ny < MAZE_SIZE) {
+        walls[MAZE_CELL(nx, ny)] |= MAZE_WALL(MAZE_OPPOSITE(dir));
+    }
+}
+
+
+// remove a wall on both sides
+static void RemoveWall(byte walls[MAZE_CELLS], int x, int y, int dir)
+{
+    int nx = x + dx[dir], ny = y + dy[dir];
+
+    walls[MAZE_CELL(x, y)] &= (byte)~MAZE_WALL(dir);
+    walls[MAZE_CELL(nx, ny)] &= (byte)~MAZE_WALL(MAZE_OPPOSITE(dir));
+}
+
+
+static int LoadText(FILE *in, byte walls[MAZE_CELLS])
+{
+    char line[TEXT_LINES][256];
+    int n = 0, k, x, y;
+    size_t len;
+
+    while (n < TEXT_LINES && fgets(line[n], sizeof(line[n]), in) != NULL) {
+        len = strcspn(line[n], "\r\n");
+        line[n][len] = '\0';
+        if (len > 0) {
+            n++;
+        }
+    }
+    if (n != TEXT_LINES) {
+        return -1;
+    }
+
+    memset(walls, 0, MAZE_CELLS);
+    for (k = 0; k < TEXT_LINES; k++) {
+        // line 2k is the north boundary of row MAZE_SIZE - 1 - k;
+        // line 2k + 1 holds the cells of that row
+        y = MAZE_SIZE - 1 - k / 2;
+        for (x = 0; x < MAZE_SIZE; x++) {
+            if (k % 2 == 0) {
+                if (strlen(line[k]) > (size_t)(4 * x + 2) && line[k][4 * x + 2] == '-') {
+                    if (y >= 0) {
+                        AddWall(walls, x, y, MAZE_DIR_NORTH);
+                    }
+                    else {
+                        AddWall(walls, x, 0, MAZE_DIR_SOUTH);
+                    }
+                }
+            }
+            else {
+                if (strlen(line[k]) > (size_t)(4 * x) && line[k][4 * x] == '|') {
+                    AddWall(walls, x, y, MAZE_DIR_WEST);
+                }
+                if (strlen(line[k]) > (size_t)(4 * x + 4) && line[k][4 * x + 4] == '|') {
+                    AddWall(walls, x, y, MAZE_DIR_EAST);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+
+int MazeFileLoad(const char *path, byte walls[MAZE_CELLS])
+{
+    FILE *in;
+    byte raw[MAZE_CELLS + 1];
+    size_t size;
+    int x, y, result;
+
+    in = fopen(path, "rb");
+    if (in == NULL) {
+        return -1;
+    }
+    size = fread(raw, 1, sizeof(raw), in);
+    if (size == MAZE_CELLS && raw[0] != 'o' && raw[0] != '+') {
+        for (x = 0; x < MAZE_SIZE; x++) {
+            for (y = 0; y < MAZE_SIZE; y++) {
+                walls[MAZE_CELL(x, y)] = raw[x * MAZE_SIZE + y] & MAZE_WALLS;
+            }
+        }
+        result = 0;
+    }
+    else {
+        rewind(in);
+        result = LoadText(in, walls);
+    }
+    fclose(in);
+    return result;
+}
+
+
+int MazeFileSaveBinary(const char *path, const byte walls[MAZE_CELLS])
+{
+    FILE *out;
+    byte raw[MAZE_CELLS];
+    int x, y;
+    size_t size;
+
+    for (x = 0; x < MAZE_SIZE; x++) {
+        for (y = 0; y < MAZE_SIZE; y++) {
+            raw[x * MAZE_SIZE + y] = walls[MAZE_CELL(x, y)] & MAZE_WALLS;
+        }
+    }
+    out = fopen(path, "wb");
+    if (out == NULL) {
+        return -1;
+    }
+    size = fwrite(raw, 1, sizeof(raw), out);
+    return (fclose(out) == 0 && size == sizeof(raw)) ? 0 : -1;
+}
+
+
+void MazeFilePrint(FILE *out, const byte walls[MAZE_CELLS])
+{
+    int x, y;
+
+    for (y = MAZE_SIZE - 1; y >= 0; y--) {
+        for (x = 0; x < MAZE_SIZE; x++) {
+            fputs((walls[MAZE_CELL(x, y)] & MAZE_NORTH) ? "o---" : "o   ", out);
+        }
+        fputs("o\n", out);
+        for (x = 0; x < MAZE_SIZE; x++) {
+            fputs((walls[MAZE_CELL(x, y)] & MAZE_WEST) ? "|   " : "    ", out);
+        }
+        fputs((walls[MAZE_CELL(MAZE_SIZE - 1, y)] & MAZE_EAST) ? "|\n" : " \n", out);
+    }
+    for (x = 0; x < MAZE_SIZE; x++) {
+        fputs((walls[MAZE_CELL(x, 0)] & MAZE_SOUTH) ? "o---" : "o   ", out);
+    }
+    fputs("o\n", out);
+}
+
+
+// linear congruential generator; the same seed gives the same maze everywhere
+static unsigned long Random(unsigned long *state)
+{
+    *state = (*state * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    return *state >> 8;
+}
+
+
+void MazeFileGenerate(unsigned long seed, byte walls[MAZE_CELLS])
+{
+    byte stack[MAZE_CELLS], seen[MAZE_CELLS];
+    int top, x, y, dir, options[4], count, i;
+    unsigned long state = seed * 2654435761UL + 1UL;
+    byte cell;
+
+    // start with every wall, leave the start cell to the north, then carve
+    // a perfect maze by depth-first search
+    memset(walls, MAZE_WALLS, MAZE_CELLS);
+    memset(seen, 0, sizeof(seen));
+    RemoveWall(walls, 0, 0, MAZE_DIR_NORTH);
+    seen[MAZE_START] = 1;
+    top = 0;
+    stack[top++] = MAZE_CELL(0, 1);
+    seen[MAZE_CELL(0, 1)] = 1;
+    while (top > 0) {
+        cell = stack[top - 1];
+        x = MAZE_X(cell);
+        y = MAZE_Y(cell);
+        count = 0;
+        for (dir = 0; dir < 4; dir++) {
+            int nx = x + dx[dir], ny = y + dy[dir];
+            if (nx >= 0 && nx < MAZE_SIZE && ny >= 0 && ny < MAZE_SIZE
+                && !seen[MAZE_CELL(nx, ny)]) {
+                options[count++] = dir;
+            }
+        }
+        if (count == 0) {
+            top--;
+            continue;
+        }
+        dir = options[Random(&state) % (unsigned long)count];
+        RemoveWall(walls, x, y, dir);
+        cell = MAZE_CELL(x + dx[dir], y + dy[dir]);
+        seen[cell] = 1;
+        stack[top++] = cell;
+    }
+
+    // knock out some interior walls so that there are several routes
+    for (i = 0; i < MAZE_CELLS / 8; i++) {
+        x = (int)(Random(&state) % (MAZE_SIZE - 1));
+        y = (int)(Random(&state) % (MAZE_SIZE - 1));
+        RemoveWall(walls, x, y, (Random(&state) & 1) ? MAZE_DIR_NORTH : MAZE_DIR_EAST);
+    }
+
+    // open the centre square and keep the start cell closed to the east
+    RemoveWall(walls, MAZE_SIZE / 2 - 1, MAZE_SIZE / 2 - 1, MAZE_DIR_NORTH);
+    RemoveWall(walls, MAZE_SIZE / 2 - 1, MAZE_SIZE / 2 - 1, MAZE_DIR_EAST);
+    RemoveWall(walls, MAZE_SIZE / 2, MAZE_SIZE / 2, MAZE_DIR_SOUTH);
+    RemoveWall(walls, MAZE_SIZE / 2, MAZE_SIZE / 2, MAZE_DIR_WEST);
+    AddWall(walls, 0, 0, MAZE_DIR_EAST);
+}
+
+
+int MazeFileShortest(const byte walls[MAZE_CELLS])
+{
+    int dist[MAZE_CELLS], queue[MAZE_CELLS];
+    int head = 0, tail = 0, cell, dir, x, y, next;
+
+    for (cell = 0; cell < MAZE_CELLS; cell++) {
+        dist[cell] = -1;
+    }
+    dist[MAZE_START] = 0;
+    queue[tail++] = MAZE_START;
+    while (head < tail) {
+        cell = queue[head++];
+        if (MazeIsGoal((byte)cell)) {
+            return dist[cell];
+        }
+        x = MAZE_X(cell);
+        y = MAZE_Y(cell);
+        for (dir = 0; dir < 4; dir++) {
+            if (walls[cell] & MAZE_WALL(dir)) {
+                continue;
+            }
+            if (x + dx[dir] < 0 || x + dx[dir] >= MAZE_SIZE
+                || y + dy[dir] < 0 || y + dy[dir] >= MAZE_SIZE) {
+                continue;
+            }
+            next = MAZE_CELL(x + dx[dir], y + dy[dir]);
+            if (dist[next] < 0) {
+                dist[next] = dist[cell] + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+    return -1;
+}
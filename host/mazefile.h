@@ -0,0 +1,45 @@
+///
+/// @file       mazefile.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Declares functions to read, write and generate 16x16 maze files
+///             in the wall-map layout of 'maze.c'.
+///
+/// @remarks    Two formats are supported:
+///             @li binary '.maz': 256 bytes, one per cell, ordered x * 16 + y,
+///                 with walls N = 0x01, E = 0x02, S = 0x04, W = 0x08;
+///             @li text: 33 lines of posts ('o' or '+'), horizontal walls
+///                 ('---') and vertical walls ('|'), north at the top.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _HOST_MAZEFILE_H
+#define _HOST_MAZEFILE_H
+
+
+#include <stdio.h>
+#include "../mouse.h"
+
+
+/// Read a maze in either format into 'walls', indexed like mazeMap; returns 0 on success.
+int MazeFileLoad(const char *path, byte walls[MAZE_CELLS]);
+
+/// Write a maze in the binary format.
+int MazeFileSaveBinary(const char *path, const byte walls[MAZE_CELLS]);
+
+/// Write a maze in the text format.
+void MazeFilePrint(FILE *out, const byte walls[MAZE_CELLS]);
+
+/// Generate a reproducible random maze with an open centre and extra loops.
+void MazeFileGenerate(unsigned long seed, byte walls[MAZE_CELLS]);
+
+/// Length of the shortest path from the start to the centre in cells, or -1.
+int MazeFileShortest(const byte walls[MAZE_CELLS]);
+
+
+#endif  // _HOST_MAZEFILE_H
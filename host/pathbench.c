@@ -0,0 +1,192 @@
+///
+/// @file       pathbench.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Estimates fast-run times of the routes compiled by 'path.c'
+///             and compares them with driving cell by cell.
+///
+/// @remarks    The shortest route of each maze (all walls known) is timed
+///             @li cell by cell: stop in every cell and pivot for every turn;
+///             @li as merged straights and smooth 90 degree turns;
+///             @li with diagonal runs as well.
+///             Segments accelerate at PATH_ACCEL up to their speed limit and
+///             turns run at their entry speed. A route too long for
+///             pathSegments counts 0 segments and the cell by cell time.
+///             Usage: pathbench [-v] [-g count] [files ...]
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#define MAIN_PROGRAM    // this tool owns the firmware globals declared in "mouse.h"
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mazefile.h"
+
+
+#define PIVOT_TIME  0.25    ///< time of an in-place 90 degree turn in s
+
+
+static const char *typeName[] = {
+    "straight", "diagonal", "turn90", "in45", "out45", "in135", "out135", "v90"
+};
+
+
+// time to cover 'length' mm from speed v0 to v1 with a speed limit of vMax,
+// all in mm/s, at an acceleration of PATH_ACCEL
+static double Trapezoid(double length, double v0, double v1, double vMax)
+{
+    double a = PATH_ACCEL, peak;
+
+    peak = sqrt((2.0 * a * length + v0 * v0 + v1 * v1) / 2.0);
+    if (peak <= vMax) {
+        return (peak - v0) / a + (peak - v1) / a;
+    }
+    return (vMax - v0) / a + (vMax - v1) / a
+        + (length - (vMax * vMax - v0 * v0) / (2.0 * a) - (vMax * vMax - v1 * v1) / (2.0 * a)) / vMax;
+}
+
+
+// time to drive the compiled segments
+static double PathTime(void)
+{
+    double t = 0.0, v0, v1, limit;
+    byte i, type;
+
+    for (i = 0; i < pathCount; i++) {
+        type = pathSegments[i].type & PATH_TYPE;
+        v0 = pathSegments[i].entrySpeed * (double)PATH_SPEED_UNIT;
+        v1 = pathSegments[i].exitSpeed * (double)PATH_SPEED_UNIT;
+        if (type == PATH_STRAIGHT || type == PATH_DIAGONAL) {
+            limit = (type == PATH_STRAIGHT ? PATH_MAX_SPEED : PATH_DIAGONAL_SPEED) * (double)PATH_SPEED_UNIT;
+            t += Trapezoid(PathSegmentLength(i), v0, v1, limit);
+        }
+        else {
+            t += PathSegmentLength(i) / (v0 > 0.0 ? v0 : PATH_TURN90_SPEED * (double)PATH_SPEED_UNIT);
+        }
+    }
+    return t;
+}
+
+
+// time to drive the route cell by cell, and the numbers of cells and turns
+static double CellTime(int *cells, int *turns)
+{
+    byte savedCell = mazeCell, savedHeading = mazeHeading, dir;
+    double step = Trapezoid(PATH_CELL_MM, 0.0, 0.0, PATH_MAX_SPEED * (double)PATH_SPEED_UNIT);
+
+    *cells = 0;
+    *turns = 0;
+    mazeCell = MAZE_START;
+    mazeHeading = MAZE_DIR_NORTH;
+    while (!MazeIsGoal(mazeCell) && *cells < MAZE_CELLS) {
+        dir = MazeNextDirection();
+        if (dir != mazeHeading) {
+            (*turns)++;
+        }
+        MazeMove(dir);
+        (*cells)++;
+    }
+    mazeCell = savedCell;
+    mazeHeading = savedHeading;
+    return *cells * step + *turns * PIVOT_TIME;
+}
+
+
+static void List(void)
+{
+    byte i;
+
+    for (i = 0; i < pathCount; i++) {
+        printf("  %2u %-8s %-5s %3u  %5u -> %5u mm/s\n", i,
+               typeName[pathSegments[i].type & PATH_TYPE],
+               (pathSegments[i].type & PATH_TYPE) <= PATH_DIAGONAL ? ""
+               : (pathSegments[i].type & PATH_RIGHT) ? "right" : "left",
+               pathSegments[i].length,
+               pathSegments[i].entrySpeed * PATH_SPEED_UNIT,
+               pathSegments[i].exitSpeed * PATH_SPEED_UNIT);
+    }
+}
+
+
+static void Bench(const char *name, const byte walls[MAZE_CELLS], int verbose,
+                  double total[3])
+{
+    double t[3];
+    int cells, turns, i, n[2];
+
+    MazeInit();
+    for (i = 0; i < MAZE_CELLS; i++) {
+        MazeSetWalls((byte)i, walls[i]);
+    }
+    MazeFlood(0);
+    if (mazeDist[MAZE_START] == MAZE_UNREACHED) {
+        printf("%-24s no route\n", name);
+        return;
+    }
+
+    t[0] = CellTime(&cells, &turns);
+    for (i = 0; i < 2; i++) {
+        if (PathCompile((byte)i)) {
+            n[i] = pathCount;
+            t[i + 1] = PathTime();
+        }
+        else {
+            n[i] = 0;           // too long to compile: driven cell by cell
+            t[i + 1] = t[0];
+        }
+    }
+    printf("%-24s %5d %5d %8.2f %8d %8.2f %8d %8.2f\n",
+           name, cells, turns, t[0], n[0], t[1], n[1], t[2]);
+    if (verbose) {
+        List();
+    }
+    for (i = 0; i < 3; i++) {
+        total[i] += t[i];
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    byte walls[MAZE_CELLS];
+    char name[32];
+    double total[3] = { 0.0, 0.0, 0.0 };
+    int verbose = 0, generate = 0, i;
+
+    printf("%-24s %5s %5s %8s %8s %8s %8s %8s\n",
+           "maze", "cells", "turns", "cell(s)", "segs", "turn(s)", "segs", "diag(s)");
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        }
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            generate = atoi(argv[++i]);
+        }
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-v] [-g count] [files ...]\n", argv[0]);
+            return 2;
+        }
+        else if (MazeFileLoad(argv[i], walls) != 0) {
+            fprintf(stderr, "%s: cannot read maze\n", argv[i]);
+            return 1;
+        }
+        else {
+            Bench(argv[i], walls, verbose, total);
+        }
+    }
+    for (i = 1; i <= generate; i++) {
+        MazeFileGenerate((unsigned long)i, walls);
+        snprintf(name, sizeof(name), "random%03d", i);
+        Bench(name, walls, verbose, total);
+    }
+    printf("total: cell by cell %.2f s, straights and turns %.2f s, with diagonals %.2f s\n",
+           total[0], total[1], total[2]);
+    return 0;
+}
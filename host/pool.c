@@ -0,0 +1,157 @@
+///
+/// @file       pool.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the work-stealing pool.
+///
+/// @remarks    Each worker owns a range [lo, hi) of job indices packed into
+///             one 64-bit word. The owner takes jobs from 'lo'; an idle worker
+///             steals the upper half of the largest remaining range. Both
+///             sides update the word with compare-and-swap.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "pool.h"
+
+
+#define POOL_MAX_WORKERS    256
+
+
+typedef struct {
+    uint64_t range;         ///< lo in the lower, hi in the upper 32 bits
+    char pad[56];           ///< keep each range on its own cache line
+} PoolRange;
+
+
+#define PACK(lo, hi)    (((uint64_t)(hi) << 32) | (uint32_t)(lo))
+#define LO(r)           ((long)(uint32_t)(r))
+#define HI(r)           ((long)((r) >> 32))
+
+
+// take the next job from the own range; returns -1 when it is empty
+static long TakeOwn(PoolRange *own)
+{
+    uint64_t r = __atomic_load_n(&own->range, __ATOMIC_ACQUIRE);
+
+    while (LO(r) < HI(r)) {
+        if (__atomic_compare_exchange_n(&own->range, &r, PACK(LO(r) + 1, HI(r)),
+                                        0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return LO(r);
+        }
+    }
+    return -1;
+}
+
+
+// move the upper half of the largest other range into the own range
+static int Steal(PoolRange *ranges, int workers, int self)
+{
+    uint64_t r;
+    long size, best, mid;
+    int i, victim;
+
+    for (;;) {
+        victim = -1;
+        best = 0;
+        for (i = 0; i < workers; i++) {
+            r = __atomic_load_n(&ranges[i].range, __ATOMIC_ACQUIRE);
+            size = HI(r) - LO(r);
+            if (i != self && size > best) {
+                best = size;
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            return 0;   // no work left anywhere
+        }
+
+        r = __atomic_load_n(&ranges[victim].range, __ATOMIC_ACQUIRE);
+        if (HI(r) <= LO(r)) {
+            continue;
+        }
+        mid = LO(r) + (HI(r) - LO(r) + 1) / 2;
+        if (__atomic_compare_exchange_n(&ranges[victim].range, &r, PACK(LO(r), mid),
+                                        0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            __atomic_store_n(&ranges[self].range, PACK(mid, HI(r)), __ATOMIC_RELEASE);
+            return 1;
+        }
+    }
+}
+
+
+static void Work(PoolRange *ranges, int workers, int self,
+                 PoolJob job, void *context, char *results, size_t resultSize)
+{
+    long index;
+
+    do {
+        while ((index = TakeOwn(&ranges[self])) >= 0) {
+            job(index, results + (size_t)index * resultSize, context);
+        }
+    } while (Steal(ranges, workers, self));
+}
+
+
+int PoolRun(long count, PoolJob job, void *context,
+            void *results, size_t resultSize, int workers)
+{
+    PoolRange *ranges;
+    char *shared;
+    size_t rangeBytes, resultBytes;
+    pid_t pid[POOL_MAX_WORKERS];
+    int i, status, failed = 0;
+
+    if (workers <= 0) {
+        workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (workers < 1) {
+        workers = 1;
+    }
+    if (workers > POOL_MAX_WORKERS) {
+        workers = POOL_MAX_WORKERS;
+    }
+
+    rangeBytes = sizeof(PoolRange) * (size_t)workers;
+    resultBytes = resultSize * (size_t)count;
+    shared = mmap(NULL, rangeBytes + resultBytes, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        return -1;
+    }
+    ranges = (PoolRange *)shared;
+
+    // start with an even split; stealing balances the rest
+    for (i = 0; i < workers; i++) {
+        ranges[i].range = PACK(count * i / workers, count * (i + 1) / workers);
+    }
+
+    for (i = 0; i < workers; i++) {
+        pid[i] = fork();
+        if (pid[i] == 0) {
+            Work(ranges, workers, i, job, context, shared + rangeBytes, resultSize);
+            _exit(0);
+        }
+    }
+    for (i = 0; i < workers; i++) {
+        if (pid[i] > 0 && (waitpid(pid[i], &status, 0) < 0 || status != 0)) {
+            failed = 1;
+        }
+    }
+
+    // finish whatever is left, e.g. the ranges of workers that could not be started
+    Work(ranges, workers, 0, job, context, shared + rangeBytes, resultSize);
+
+    memcpy(results, shared + rangeBytes, resultBytes);
+    munmap(shared, rangeBytes + resultBytes);
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,36 @@
+///
+/// @file       pool.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Declares a work-stealing pool for running many independent
+///             simulations on all CPU cores of the host.
+///
+/// @remarks    The firmware keeps its state in globals, so simulations cannot
+///             share an address space. Each worker is therefore a forked
+///             process; the job ranges and the results live in shared memory.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _HOST_POOL_H
+#define _HOST_POOL_H
+
+
+#include <stddef.h>
+
+
+/// Job run by a worker; writes its outcome to 'result' (resultSize bytes).
+typedef void (*PoolJob)(long index, void *result, void *context);
+
+
+/// Run jobs 0..count-1 on 'workers' processes (0 for one per CPU) and collect
+/// their results in order into 'results'; returns 0 on success.
+int PoolRun(long count, PoolJob job, void *context,
+            void *results, size_t resultSize, int workers);
+
+
+#endif  // _HOST_POOL_H
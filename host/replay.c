@@ -0,0 +1,371 @@
+///
+/// @file       replay.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Records a trace stream from the host simulator, or replays a
+///             stream recorded on the mouse through the firmware ISRs, and
+///             prints the controller outputs of every control period.
+///
+/// @remarks    Build with TRACE defined, so that the firmware records as it
+///             does on the mouse. Replay sets the port, capture and ADC
+///             registers from the records and calls the tick and tachometer
+///             ISRs in recorded order; main-loop code ('-m avoid' or
+///             '-m line') runs between records, and every ADC conversion
+///             takes the next recorded result of its channel. Replay is open
+///             loop: recorded tachometer pulses do not react to what the
+///             controller does with them. One CSV row of duty cycles per
+///             control period goes to '-o file' (or stdout): recorded ones
+///             with '-r', replayed ones otherwise, so that a recording and its
+///             replay can be compared with 'cmp'. Replayed duty cycles that
+///             differ from the recorded ones are counted in the summary of
+///             the stream on stderr.
+///             Usage: replay -r [-t seconds] [-m none|avoid] [-o file] trace
+///                    replay [-m none|avoid|line] [-o file] trace
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include "hostsim.h"
+
+
+#ifndef TRACE
+#error "build the replay tool with -DTRACE"
+#endif
+
+
+#define TOUCH_EVERY     2.0     ///< seconds between front left touches when recording '-m avoid'
+#define TOUCH_FOR       0.1     ///< length of a touch in s
+#define ADC_QUEUE       16      ///< recorded ADC results buffered per channel
+
+
+typedef enum {
+    MODE_NONE,      ///< drive forward; ISRs only
+    MODE_AVOID,     ///< AvoidObstacleStep() between records
+    MODE_LINE       ///< LineFollowingStep() between records (replay only)
+} Mode;
+
+
+static FILE *csv;
+static FILE *trace;
+static long periods;
+static long records[8];     ///< by the high nibble of the record type
+static long lost;
+static long ticks;
+static long mismatches;
+static jmp_buf endOfTrace;
+
+
+// one row of duty cycles, at the end of a control period
+static void PrintPeriod(word pw)
+{
+    fprintf(csv, "%ld,%ld,%u,%u\n", periods, periods * controlPeriod, pw >> 8, pw & 0xFF);
+    periods++;
+}
+
+
+static void Count(byte type, word value)
+{
+    records[(type >> 4) & 7]++;
+    if (type == TRACE_LOST) {
+        lost += value;
+    }
+    if (type == TRACE_TICKS) {
+        ticks += value;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+//  Recording
+//------------------------------------------------------------------------------
+// SCI sink: write the stream and print the row of every TRACE_PERIOD once
+// the TRACE_TICKS record that completes its tick follows, as replay does
+static void Record(byte ch)
+{
+    static byte record[3];
+    static int n;
+    static word pw;
+    static byte pending;
+
+    fputc(ch, trace);
+    record[n++] = ch;
+    if (n == 3) {
+        n = 0;
+        Count(record[0], (word)(record[1] << 8 | record[2]));
+        if (record[0] == TRACE_PERIOD) {
+            pw = (word)(record[1] << 8 | record[2]);
+            pending = 1;
+        }
+        else if (record[0] == TRACE_TICKS && pending) {
+            PrintPeriod(pw);
+            pending = 0;
+        }
+    }
+}
+
+
+static void RecordRun(Mode mode, double seconds)
+{
+    double t;
+
+    HostReset(&hostDefaultPlant);
+    TraceInit();        // restart the stream after the start-up captures of HostReset()
+    HostSetSCISink(Record);
+
+    ControlMouse(MOUSE_ACTION_FORWARD);
+    while (HostTime() < seconds) {
+        if (mode == MODE_AVOID) {
+            // touch the front left bar now and then
+            t = HostTime() - TOUCH_EVERY * (long)(HostTime() / TOUCH_EVERY);
+            PTAD_PTAD1 = (t >= TOUCH_EVERY - TOUCH_FOR);
+            AvoidObstacleStep();
+        }
+        HostStep();
+    }
+    HostSetSCISink(0);
+}
+
+
+//------------------------------------------------------------------------------
+//  Replay
+//------------------------------------------------------------------------------
+// read the next record; 0 at the end of the stream
+static int Next(byte *type, word *value)
+{
+    int hi, lo;
+
+    *type = (byte)fgetc(trace);
+    hi = fgetc(trace);
+    lo = fgetc(trace);
+    if (lo == EOF) {
+        return 0;
+    }
+    *value = (word)(hi << 8 | lo);
+    Count(*type, *value);
+    return 1;
+}
+
+
+static byte adcQueue[8][ADC_QUEUE];
+static byte adcHead[8], adcCount[8];
+static word expected;       // recorded duty cycles of the control period being replayed
+static byte pending;        // a control period ends in the next tick
+
+
+// deliver one record to the firmware; returns 0 at the end of the stream
+static int Deliver(void)
+{
+    byte type;
+    word value, n;
+    signed char adjust;
+
+    if (!Next(&type, &value)) {
+        return 0;
+    }
+    switch (type & 0xF0) {
+    case TRACE_START:
+        if (value != TPM2MOD) {
+            fprintf(stderr, "warning: trace was recorded with TPM2MOD %u, not %u\n", value, TPM2MOD);
+        }
+        break;
+    case TRACE_PERIOD:
+        // recorded inside the tick that the next TRACE_TICKS record completes
+        expected = value;
+        pending = 1;
+        break;
+    case TRACE_TICKS:
+        for (n = 0; n < value; n++) {
+            TPM2SC_TOF = 1;
+            TPM2CNT = 0;
+            intTPM2OVF();
+            if (pending) {
+                pending = 0;
+                PrintPeriod((word)(pwLeft << 8 | (pwRight & 0xFF)));
+                mismatches += (pwLeft != expected >> 8 || pwRight != (expected & 0xFF));
+            }
+        }
+        break;
+    case TRACE_TACH_LEFT:
+        // reproduce the state of the tick that the ISR found
+        adjust = (signed char)(((type >> 2) & 3) - 1);
+        TPM2SC_TOF = (adjust > 0);
+        TPM2CNT = (adjust < 0) ? 0 : value;
+        if (type & 1) {
+            TPM2C1V = value;
+            TPM2C1SC_CH1F = 1;
+            intTPM2CH1();
+        }
+        else {
+            TPM2C0V = value;
+            TPM2C0SC_CH0F = 1;
+            intTPM2CH0();
+        }
+        TPM2SC_TOF = 0;
+        break;
+    case TRACE_ADC:
+        if (adcCount[type & 7] < ADC_QUEUE) {
+            adcQueue[type & 7][(adcHead[type & 7] + adcCount[type & 7]) % ADC_QUEUE] = (byte)value;
+            adcCount[type & 7]++;
+        }
+        break;
+    case TRACE_INPUTS:
+        // read by the next TaskInput()
+        PTAD = (byte)(value >> 8);
+        PTDD = (byte)value;
+        break;
+    case TRACE_LOST:
+        fprintf(stderr, "warning: %u records lost after period %ld\n", value, periods);
+        break;
+    default:
+        break;
+    }
+
+    // the firmware traces the replay as well; nobody listens
+    while (SCI2C2_TIE) {
+        intSCI2TX();
+    }
+    return 1;
+}
+
+
+// ADC reader: the next recorded result of the channel
+static byte ReplayADC(byte ch)
+{
+    byte value;
+
+    ch &= 7;
+    while (adcCount[ch] == 0) {
+        if (!Deliver()) {
+            longjmp(endOfTrace, 1);
+        }
+    }
+    value = adcQueue[ch][adcHead[ch]];
+    adcHead[ch] = (byte)((adcHead[ch] + 1) % ADC_QUEUE);
+    adcCount[ch]--;
+    return value;
+}
+
+
+static void ReplayRun(Mode mode)
+{
+    HostReset(&hostDefaultPlant);
+    TraceInit();
+    HostSetADCReader(ReplayADC);
+    if (mode == MODE_NONE) {
+        ControlMouse(MOUSE_ACTION_FORWARD);     // as the recording does
+    }
+
+    if (setjmp(endOfTrace) == 0) {
+        for (;;) {
+            if (mode == MODE_LINE) {
+                LineFollowingStep();    // its ADC conversions pull the records
+                continue;
+            }
+            if (!Deliver()) {
+                break;
+            }
+            if (mode == MODE_AVOID) {
+                AvoidObstacleStep();
+            }
+        }
+    }
+    HostSetADCReader(0);
+}
+
+
+//------------------------------------------------------------------------------
+//  Main
+//------------------------------------------------------------------------------
+static void Summary(int record, double cpu)
+{
+    static const char *names[8] = { "", "start", "period", "tach", "adc", "inputs", "lost", "ticks" };
+    double seconds = (double)ticks * tickPeriod / 1000.0;
+    long bytes = 0;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        if (records[i] != 0) {
+            fprintf(stderr, "%-8s %8ld\n", names[i], records[i]);
+            bytes += 3 * records[i];
+        }
+    }
+    fprintf(stderr, "%ld records lost\n", lost);
+    if (!record) {
+        fprintf(stderr, "%ld of %ld control periods differ from the recording\n", mismatches, periods);
+    }
+    if (seconds > 0.0) {
+        fprintf(stderr, "%.2f s of mouse time, %.0f bytes/s on the SCI (%.0f baud)\n",
+                seconds, bytes / seconds, 10.0 * bytes / seconds);
+        fprintf(stderr, "%.3f s of host time, %.0f times real time\n", cpu, seconds / (cpu > 0.0 ? cpu : 1e-9));
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    Mode mode = MODE_NONE;
+    double seconds = 10.0;
+    const char *out = 0, *name = 0;
+    int record = 0, i;
+    clock_t start;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r")) {
+            record = 1;
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            out = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+            i++;
+            mode = !strcmp(argv[i], "avoid") ? MODE_AVOID : !strcmp(argv[i], "line") ? MODE_LINE : MODE_NONE;
+        }
+        else if (argv[i][0] != '-' && name == 0) {
+            name = argv[i];
+        }
+        else {
+            name = 0;
+            break;
+        }
+    }
+    if (name == 0 || (record && mode == MODE_LINE)) {
+        fprintf(stderr, "usage: %s -r [-t seconds] [-m none|avoid] [-o file] trace\n"
+                        "       %s [-m none|avoid|line] [-o file] trace\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    trace = fopen(name, record ? "wb" : "rb");
+    csv = out ? fopen(out, "w") : stdout;
+    if (trace == 0 || csv == 0) {
+        perror(trace == 0 ? name : out);
+        return 1;
+    }
+    fprintf(csv, "period,ms,pwLeft,pwRight\n");
+
+    start = clock();
+    if (record) {
+        RecordRun(mode, seconds);
+    }
+    else {
+        ReplayRun(mode);
+    }
+    Summary(record, (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    fclose(trace);
+    if (csv != stdout) {
+        fclose(csv);
+    }
+    return 0;
+}
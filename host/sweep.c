@@ -0,0 +1,227 @@
+///
+/// @file       sweep.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Tunes the speed controller by running the firmware control code
+///             in the host simulator over a grid of gains and limits.
+///
+/// @remarks    Every candidate drives a straight lap on several plant models
+///             (mismatched motors, tired battery) and is scored on its worst
+///             case; the best candidate is printed as the '#define' block of
+///             'mouse.h'. Usage: sweep [-j workers] [-n top]
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "hostsim.h"
+#include "pool.h"
+
+
+#define LAP_DISTANCE    2000    ///< length of the lap in units of travelDistance
+#define LAP_TIMEOUT     15.0    ///< give up on a lap after this many seconds
+#define SETTLE_BAND     0.05    ///< relative speed error regarded as settled
+#define OVERSHOOT_COST  2.0     ///< seconds of score per 100% overshoot
+
+
+/// @name Candidate grid
+//@{
+static const int gridScaleFactor[] = { 50, 100, 200, 400, 800 };
+static const int gridNomPeriod[] = { 2048, 2560, 3072, 3584, 4096, 4608, 5120, 5632, 6144 };
+static const int gridPwMax[] = { 80, 90, 100 };
+static const int gridPwMin[] = { 5, 10, 20 };
+static const int gridSpeedStep[] = { 1, 2, 4, 8 };
+static const int gridSpeed[] = { 25, 33, 50 };
+//@}
+
+#define COUNT(a)    ((long)(sizeof(a) / sizeof((a)[0])))
+
+
+typedef struct {
+    int scaleFactor;
+    int nomPeriod;
+    int pwMax;
+    int pwMin;
+    int speedStep;
+    int speed;
+} Candidate;
+
+typedef struct {
+    double score;       ///< worst-case score over all plants; lower is better
+    double settle;      ///< time until both wheels stay within SETTLE_BAND, in s
+    double overshoot;   ///< peak speed above the target, relative to the target
+    double lap;         ///< time to travel LAP_DISTANCE, in s
+} Outcome;
+
+
+// decode a candidate from its index in the grid
+static Candidate Decode(long index)
+{
+    Candidate c;
+
+    c.scaleFactor = gridScaleFactor[index % COUNT(gridScaleFactor)];
+    index /= COUNT(gridScaleFactor);
+    c.nomPeriod = gridNomPeriod[index % COUNT(gridNomPeriod)];
+    index /= COUNT(gridNomPeriod);
+    c.pwMax = gridPwMax[index % COUNT(gridPwMax)];
+    index /= COUNT(gridPwMax);
+    c.pwMin = gridPwMin[index % COUNT(gridPwMin)];
+    index /= COUNT(gridPwMin);
+    c.speedStep = gridSpeedStep[index % COUNT(gridSpeedStep)];
+    index /= COUNT(gridSpeedStep);
+    c.speed = gridSpeed[index % COUNT(gridSpeed)];
+    return c;
+}
+
+
+// drive one lap on a plant and measure the response
+static Outcome RunLap(const Candidate *c, const HostPlant *plant)
+{
+    Outcome o;
+    double target, v, err;
+    int i;
+
+    HostReset(plant);
+    scaleFactor = c->scaleFactor;
+    nomSpeed = (int)TPM2_COUNTS(c->nomPeriod);
+    pwMax = (word)c->pwMax;
+    pwMin = (word)c->pwMin;
+    speedStep = (word)c->speedStep;
+    pwLeft = pwRight = (word)c->speed;
+
+    // wheel speed in pulses/s that corresponds to the nominal tachometer period
+    target = 1e6 / (double)c->nomPeriod;
+
+    o.settle = 0.0;
+    o.overshoot = 0.0;
+    travelDistance = LAP_DISTANCE;
+    ControlMouse(MOUSE_ACTION_FORWARD);
+    while (travelDistance > 0 && HostTime() < LAP_TIMEOUT) {
+        HostStep();
+        for (i = 0; i < 2; i++) {
+            v = HostWheelSpeed((Motor)i);
+            err = (v - target) / target;
+            if (fabs(err) > SETTLE_BAND) {
+                o.settle = HostTime();
+            }
+            if (err > o.overshoot) {
+                o.overshoot = err;
+            }
+        }
+    }
+    o.lap = (travelDistance > 0) ? LAP_TIMEOUT : HostTime();
+    o.score = o.settle + o.lap + OVERSHOOT_COST * o.overshoot;
+    return o;
+}
+
+
+// score a candidate by its worst lap over the plant variations
+static void Evaluate(long index, void *result, void *context)
+{
+    static const double battery[] = { 1.0, 0.8 };
+    Candidate c = Decode(index);
+    HostPlant plant;
+    Outcome o, worst;
+    int b, swap;
+
+    worst.score = -1.0;
+    for (b = 0; b < 2; b++) {
+        for (swap = 0; swap < 2; swap++) {
+            plant = hostDefaultPlant;
+            plant.battery = battery[b];
+            if (swap) {
+                plant.motor[MOTOR_LEFT] = hostDefaultPlant.motor[MOTOR_RIGHT];
+                plant.motor[MOTOR_RIGHT] = hostDefaultPlant.motor[MOTOR_LEFT];
+            }
+            o = RunLap(&c, &plant);
+            if (o.score > worst.score) {
+                worst = o;
+            }
+        }
+    }
+    (void)context;
+    *(Outcome *)result = worst;
+}
+
+
+int main(int argc, char *argv[])
+{
+    long count, i, j, best, *order;
+    Outcome *results;
+    Candidate c;
+    int workers = 0, top = 10;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            top = atoi(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-j workers] [-n top]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    count = COUNT(gridScaleFactor) * COUNT(gridNomPeriod) * COUNT(gridPwMax)
+        * COUNT(gridPwMin) * COUNT(gridSpeedStep) * COUNT(gridSpeed);
+    results = malloc(sizeof(Outcome) * (size_t)count);
+    order = malloc(sizeof(long) * (size_t)count);
+    if (results == NULL || order == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    fprintf(stderr, "evaluating %ld candidates ...\n", count);
+    if (PoolRun(count, Evaluate, NULL, results, sizeof(Outcome), workers) != 0) {
+        fprintf(stderr, "some workers failed\n");
+        return 1;
+    }
+
+    // partial selection sort of the best 'top' candidates
+    for (i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    if (top > count) {
+        top = (int)count;
+    }
+    for (i = 0; i < top; i++) {
+        best = i;
+        for (j = i + 1; j < count; j++) {
+            if (results[order[j]].score < results[order[best]].score) {
+                best = j;
+            }
+        }
+        j = order[i];
+        order[i] = order[best];
+        order[best] = j;
+    }
+
+    fprintf(stderr, "  score  settle    lap  overshoot  scale  nomPeriod  pwMax  pwMin  step  speed\n");
+    for (i = 0; i < top; i++) {
+        c = Decode(order[i]);
+        fprintf(stderr, "%7.3f %7.3f %6.3f %9.1f%% %6d %10d %6d %6d %5d %6d\n",
+                results[order[i]].score, results[order[i]].settle, results[order[i]].lap,
+                100.0 * results[order[i]].overshoot, c.scaleFactor, c.nomPeriod,
+                c.pwMax, c.pwMin, c.speedStep, c.speed);
+    }
+
+    c = Decode(order[0]);
+    printf("#define defaultSpeed        %d\n", c.speed);
+    printf("#define defaultScaleFactor  %d\n", c.scaleFactor);
+    printf("#define defaultNomPeriod    %d\n", c.nomPeriod);
+    printf("#define defaultPwMax        %d\n", c.pwMax);
+    printf("#define defaultPwMin        %d\n", c.pwMin);
+    printf("#define defaultSpeedStep    %d\n", c.speedStep);
+
+    free(order);
+    free(results);
+    return 0;
+}
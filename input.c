@@ -0,0 +1,145 @@
+///
+/// @file       input.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements debouncing of the digital inputs (touch bars,
+///             infrared sensors and the SW3/SW4 switches) with edge events.
+///
+/// @remarks    InputSample() is called by TaskInput() once every input
+///             period. Each input has a two-bit vertical counter; all
+///             eight are kept in two bytes and updated together. An input
+///             changes its stable level only after INPUT_DEBOUNCE samples in
+///             a row disagree with it, and the change is queued as an event
+///             stamped with inputTime and with schedTicks of the first of
+///             those samples, from which the reaction to it is timed.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static byte count0, count1;     // vertical counters, bit i for input i
+static word inputStart[8];      // schedTicks of the first sample that differed, per input
+static InputEvent inputQueue[INPUT_QUEUE_SIZE];
+static volatile byte inputHead;     // next event to read; written by the main loop
+static volatile byte inputTail;     // next free entry; written by the ISR
+
+
+// raw input bits, active high, in INPUT_* positions
+static byte ReadInputs(void)
+{
+    byte raw = 0;
+
+    if (touchBarFrontLeft) {
+        raw |= INPUT_TOUCH_FRONT_LEFT;
+    }
+    if (touchBarFrontRight) {
+        raw |= INPUT_TOUCH_FRONT_RIGHT;
+    }
+    if (touchBarRearLeft) {
+        raw |= INPUT_TOUCH_REAR_LEFT;
+    }
+    if (touchBarRearRight) {
+        raw |= INPUT_TOUCH_REAR_RIGHT;
+    }
+    if (wallSensing) {
+        // the receivers are read through the ADC
+        if (wallDistance[MOTOR_LEFT] < WALL_DETECT) {
+            raw |= INPUT_IR_FRONT_LEFT;
+        }
+        if (wallDistance[MOTOR_RIGHT] < WALL_DETECT) {
+            raw |= INPUT_IR_FRONT_RIGHT;
+        }
+    }
+    else {
+        if (infraredFrontLeft) {
+            raw |= INPUT_IR_FRONT_LEFT;
+        }
+        if (infraredFrontRight) {
+            raw |= INPUT_IR_FRONT_RIGHT;
+        }
+    }
+    if (!PTDD_PTDD3) {
+        raw |= INPUT_SW3;       // the switches pull their pins low
+    }
+    if (!PTDD_PTDD2) {
+        raw |= INPUT_SW4;
+    }
+    return raw;
+}
+
+
+// queue an event; dropped if the queue is full
+static void Post(byte input, byte active, word start)
+{
+    byte next = (byte)((inputTail + 1) & (INPUT_QUEUE_SIZE - 1));
+
+    if (next == inputHead) {
+        return;
+    }
+    inputQueue[inputTail].input = input;
+    inputQueue[inputTail].active = active;
+    inputQueue[inputTail].time = inputTime;
+    inputQueue[inputTail].start = start;
+    inputTail = next;   // publish the event only after it is complete
+}
+
+
+// reset the stable levels to the current inputs and drop pending events
+void InputInit(void)
+{
+    inputLevels = ReadInputs();
+    count0 = count1 = 0;
+    inputTime = 0;
+    inputHead = inputTail;
+}
+
+
+// take one sample; returns the inputs whose stable level changed
+byte InputSample(void)
+{
+    byte delta, fresh, changed, bit, i;
+
+    inputTime++;
+
+    // count samples that differ from the stable level; any agreeing sample
+    // clears an input's counter, and the fourth differing one in a row
+    // wraps it to zero and flips the level
+    delta = ReadInputs() ^ inputLevels;
+    fresh = delta & ~(count0 | count1);     // the first sample to differ
+    count1 = (count1 ^ count0) & delta;
+    count0 = ~count0 & delta;
+    changed = delta & ~(count0 | count1);
+    if ((fresh | changed) == 0) {
+        return 0;
+    }
+
+    inputLevels ^= changed;
+    for (bit = 1, i = 0; bit != 0; bit <<= 1, i++) {
+        if (fresh & bit) {
+            inputStart[i] = schedTicks;
+        }
+        if (changed & bit) {
+            Post(bit, (inputLevels & bit) != 0, inputStart[i]);
+            LatencyEdge(inputStart[i]);
+        }
+    }
+    return changed;
+}
+
+
+// take the oldest event; returns 0 if there is none
+byte InputGetEvent(InputEvent *event)
+{
+    if (inputHead == inputTail) {
+        return 0;
+    }
+    *event = inputQueue[inputHead];
+    inputHead = (byte)((inputHead + 1) & (INPUT_QUEUE_SIZE - 1));
+    return 1;
+}
@@ -16,61 +16,66 @@
 #include "mouse.h"	// for the declaration of types, constants, variables and functions
 
 
+// the switches bounce, so they are acted on by TaskInput() once debounced
 interrupt VectorNumber_Vkeyboard1 void intSW3_4()
 {
-    byte sw3, sw4;
-    
-  sw3 = PTDD_PTDD3;
-  sw4 = PTDD_PTDD2;
-
-  // simple FSM for motor status handling
-  if (sw3 == 0) {
-    // for left motor
-    switch (leftMotor) {
-      case MOTOR_STATUS_STOP:
-        ControlMotor(MOTOR_LEFT, MOTOR_ACTION_FORWARD);
-        break;
-      case MOTOR_STATUS_FORWARD:
-        ControlMotor(MOTOR_LEFT, MOTOR_ACTION_REVERSE);
-        break;
-      case MOTOR_STATUS_REVERSE:
-        ControlMotor(MOTOR_LEFT, MOTOR_ACTION_STOP);
-        break;
+    KBI1SC_KBACK = 1;   // clear KBI interrupt flag
+}
+
+
+// ticks to add to schedTicks for a capture: +1 if the counter wrapped before
+// the capture but the tick is still pending, -1 if the capture was taken
+// before the last wrap; assumes the ISR is entered within a tick, which
+// holds unless the tasks of a tick overran (see schedSlip)
+static signed char TachAdjust(word capture)
+{
+    byte pending;
+    word now;
+
+    do {    // TOF and the count of the same instant, though the counter may wrap between them
+        pending = TPM2SC_TOF;
+        now = TPM2CNT;
+    } while (TPM2SC_TOF != pending);
+    return (signed char)(pending - (capture > now));
+}
+
+
+// set '*period' to the TPM2 counts since the last capture of a tachometer,
+// saturated at 0xFFFF; the tick count extends TPM2CNT, so any TPM2 period
+// works. Ticks may have been lost in a tick whose tasks overran, which
+// makes the count whole ticks short, so a period spanning schedSlip is
+// dropped, and '*period' keeps the last good one
+static void TachPeriod(word capture, signed char adjust, word *period, word *lastCapture, word *lastTicks)
+{
+    word ticks = (word)(schedTicks + adjust);
+    word since = ticks - *lastTicks;
+    long counts = (long)since * ((long)TPM2MOD + 1) + (long)capture - (long)*lastCapture;
+
+    if (counts > 0xFFFF) {
+        *period = 0xFFFF;   // lost ticks only shorten it, so it is long in any case
     }
-  } else if (sw4 == 0) {
-    // for right motor
-    switch (rightMotor) {
-      case MOTOR_STATUS_STOP:
-        ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_FORWARD);
-        break;
-      case MOTOR_STATUS_FORWARD:
-        ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_REVERSE);
-        break;
-      case MOTOR_STATUS_REVERSE:
-        ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_STOP);
-        break;
+    else if ((word)(schedSlip - *lastTicks) > since) {
+        *period = (counts < 0) ? 0 : (word)counts;
     }
-  }
-  
-  // 'braking' hasn't been implemented yet
-   
-  KBI1SC_KBACK = 1; // clear KBI interrupt flag
+    *lastCapture = capture;
+    *lastTicks = ticks;
 }
 
 
-// ISR to provide distance feedback to motor control functions
-// based on tacho meter
+// ISR of the scheduler tick; runs the periodic tasks in 'sched.c'
 interrupt VectorNumber_Vtpm2ovf void intTPM2OVF()
 {
     byte tmp;
+    word start = LoadEnter(0);  // time this ISR for the CPU load, from the overflow
 
     // clear TPM2 timer overflow flag    
     tmp = TPM2SC_TOF;   // first, need to read from TPM2 timer overflow flag
     TPM2SC_TOF = 0;     // then, clear TPM2 timer overflow flag
-  
-    if ((leftMotor != MOTOR_STATUS_STOP) && (rightMotor != MOTOR_STATUS_STOP)) {
-        ControlSpeed();	// balance the speeds of motors when both are moving
-    }
+
+    SchedTick();        // run the tasks due in this tick
+    TRACE_TICK();
+
+    LoadExit(LOAD_TPM2OVF, start);
 }
 
 
@@ -78,18 +83,28 @@ interrupt VectorNumber_Vtpm2ovf void intTPM2OVF()
 interrupt VectorNumber_Vtpm2ch0 void intTPM2CH0()
 {
     byte tmp;
+    signed char adjust;
     static word oldLeft = 0;
+    static word oldLeftTicks = 0;
+    word start = LoadEnter(TPM2C0V);    // time this ISR for the CPU load, from the capture
 
     // clear TPM2 channel 0 flag    
     tmp = TPM2C0SC_CH0F;    // first, need to read from TPM2 channel 0 flag bit
     TPM2C0SC_CH0F = 0;      // then, clear TPM2 channel 0 flag
+    adjust = TachAdjust(TPM2C0V);
+    TRACE_RECORD(TRACE_TACH_LEFT | TRACE_TACH_ADJUST(adjust), TPM2C0V);
     
-    diffLeft = TPM2C0V - oldLeft;
-    oldLeft = TPM2C0V;
+    TachPeriod(TPM2C0V, adjust, &diffLeft, &oldLeft, &oldLeftTicks);
+    tachCount[MOTOR_LEFT]++;
     
     if (travelDistance > 0) {
         travelDistance--;	// check travelDistance and decrement if it is greater than zero
+        if (travelDistance == 0) {
+            MotionService(0);   // chain the next motion command without waiting for the navigation period
+        }
     }
+
+    LoadExit(LOAD_TPM2CH0, start);
 }
 
 
@@ -97,18 +112,27 @@ interrupt VectorNumber_Vtpm2ch0 void intTPM2CH0()
 interrupt VectorNumber_Vtpm2ch1 void intTPM2CH1()
 {
     byte tmp;
+    signed char adjust;
     static word oldRight = 0;
+    static word oldRightTicks = 0;
+    word start = LoadEnter(TPM2C1V);    // time this ISR for the CPU load, from the capture
 
     // clear TPM2 channel 1 flag    
     tmp = TPM2C1SC_CH1F;    // first, need to read from TPM2 channel 1 flag bit
     TPM2C1SC_CH1F = 0;      // then, clear TPM2 channel 1 flag
+    adjust = TachAdjust(TPM2C1V);
+    TRACE_RECORD(TRACE_TACH_RIGHT | TRACE_TACH_ADJUST(adjust), TPM2C1V);
     
-    diffRight = TPM2C1V - oldRight;
-    oldRight = TPM2C1V;
+    TachPeriod(TPM2C1V, adjust, &diffRight, &oldRight, &oldRightTicks);
+    tachCount[MOTOR_RIGHT]++;
     
     if (travelDistance > 0) {
         // check travelDistance variable and decrement if it is greater than zero
         travelDistance--;
+        if (travelDistance == 0) {
+            MotionService(0);   // chain the next motion command without waiting for the navigation period
+        }
     }
-  
+
+    LoadExit(LOAD_TPM2CH1, start);
 }
\ No newline at end of file
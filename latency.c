@@ -0,0 +1,215 @@
+///
+/// @file       latency.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the measurement of the reaction latency from an
+///             input edge to the first motor register write that it causes.
+///
+/// @remarks    An edge is stamped with the scheduler tick of the first
+///             sample that saw it: input.c stamps the changes that it
+///             accepts, and the line following loop the crossings of its
+///             thresholds. The first write to TPM1CxV after the edge that
+///             switches a motor to another direction, or to brake or stop,
+///             closes the measurement, to the TPM2 count; so does the first
+///             one that changes a duty cycle once ControlMouse(), ControlArc()
+///             or the combat mode have called LatencyCommand() for a new
+///             straight, arc or push. Only one edge is timed at a time; a
+///             newer edge takes the place of one that has caused no command
+///             yet, and reactions later than LATENCY_TIMEOUT ms are dropped.
+///             The latencies go into a histogram of the current mouseMode
+///             with bins of octaves of ms, for LatencyReport() and, in the
+///             combat mode, CombatReport().
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static byte latencyArmed;       // an edge is being timed
+static byte latencyCommanded;   // the motors have been told to react to it
+static word latencyStart;       // schedTicks of the edge
+
+// statistics per mouseMode; latencies in 0.1 ms
+static word latencyCount[MOUSE_MODES];
+static word latencyWorst[MOUSE_MODES];
+static dword latencySum[MOUSE_MODES];
+static word latencyDropped[MOUSE_MODES];
+static word latencyHist[MOUSE_MODES][LATENCY_BINS];
+
+
+// clear the statistics of all modes
+void LatencyInit(void)
+{
+    byte i, j;
+
+    latencyArmed = 0;
+    latencyCommanded = 0;
+    for (i = 0; i < MOUSE_MODES; i++) {
+        latencyCount[i] = 0;
+        latencyWorst[i] = 0;
+        latencySum[i] = 0;
+        latencyDropped[i] = 0;
+        for (j = 0; j < LATENCY_BINS; j++) {
+            latencyHist[i][j] = 0;
+        }
+    }
+}
+
+
+// an input edge first seen in tick 'ticks'; edges during a manoeuvre of the
+// motion queue are not timed, as the mode loops wait for its end before they
+// look at the inputs again, and its next command is no reaction
+void LatencyEdge(word ticks)
+{
+    if (!MotionIdle()) {
+        return;
+    }
+    if (latencyArmed && latencyCommanded && (word)(ticks - latencyStart) <= LATENCY_TIMEOUT / tickPeriod) {
+        return;     // the reaction to the earlier edge is on its way
+    }
+    latencyStart = ticks;
+    latencyArmed = 1;
+    latencyCommanded = 0;
+}
+
+
+// the motors have been told to change their duty cycles for something new
+void LatencyCommand(void)
+{
+    if (latencyArmed) {
+        latencyCommanded = 1;
+    }
+}
+
+
+// a motor register is about to change; 'command' if the motor changes its
+// direction, brakes or stops. Called by the motor driver.
+void LatencyWrite(byte command)
+{
+    word ticks = schedTicks, count = TPM2CNT, latency, ms;
+    dword elapsed;
+    byte bin;
+
+    if (!latencyArmed || !(latencyCommanded || command)) {
+        return;
+    }
+    latencyArmed = 0;
+    latencyCommanded = 0;
+    if (TPM2SC_TOF) {
+        ticks++;    // the counter has wrapped, but the tick is still pending
+    }
+
+    // the edge was sampled at the start of its tick
+    elapsed = (dword)(word)(ticks - latencyStart) * (tickPeriod * 10UL)
+              + (dword)count * (tickPeriod * 10UL) / ((dword)TPM2MOD + 1);
+    latency = (elapsed > 0xFFFF) ? 0xFFFF : (word)elapsed;
+
+    if (latency > LATENCY_TIMEOUT * 10) {
+        if (latencyDropped[mouseMode] != 0xFFFF) {
+            latencyDropped[mouseMode]++;    // too late to be a reaction to the edge
+        }
+        return;
+    }
+    if (latencyCount[mouseMode] == 0xFFFF) {
+        return;     // full
+    }
+    latencyCount[mouseMode]++;
+    latencySum[mouseMode] += latency;
+    if (latency > latencyWorst[mouseMode]) {
+        latencyWorst[mouseMode] = latency;
+    }
+    bin = 0;
+    for (ms = latency / 10; ms != 0; ms >>= 1) {
+        bin++;
+    }
+    if (bin >= LATENCY_BINS) {
+        bin = LATENCY_BINS - 1;
+    }
+    latencyHist[mouseMode][bin]++;
+}
+
+
+// send a latency in 0.1 ms as ms with one decimal
+static void SendTenths(word value)
+{
+    SCISendDec(value / 10);
+    SCISendChar('.');
+    SCISendChar((char)('0' + value % 10));
+}
+
+
+// reactions timed in 'mode' so far; called from the main loop
+word LatencyReactions(MouseMode mode)
+{
+    word count;
+
+    DisableInterrupts;
+    count = latencyCount[mode];
+    EnableInterrupts;
+    return count;
+}
+
+
+// report the latencies of 'mode' on the SCI, under 'name': count, mean,
+// worst, edges dropped, and the histogram as the lower bound of each
+// non-empty bin in ms with its count
+void LatencyReportMode(MouseMode mode, char *name)
+{
+    word count, worst, dropped, hist[LATENCY_BINS];
+    dword sum;
+    byte j;
+
+    DisableInterrupts;      // the combat mode reports while the ISRs time
+    count = latencyCount[mode];
+    worst = latencyWorst[mode];
+    dropped = latencyDropped[mode];
+    sum = latencySum[mode];
+    for (j = 0; j < LATENCY_BINS; j++) {
+        hist[j] = latencyHist[mode][j];
+    }
+    EnableInterrupts;
+
+    SCISendStr(name);
+    SCISendDec(count);
+    SCISendStr(" reactions, mean ");
+    SendTenths((count != 0) ? (word)(sum / count) : 0);
+    SCISendStr(" ms, worst ");
+    SendTenths(worst);
+    SCISendStr(" ms, dropped ");
+    SCISendDec(dropped);
+    SCISendStr("\r\n   ");
+    for (j = 0; j < LATENCY_BINS; j++) {
+        if (hist[j] == 0) {
+            continue;
+        }
+        SCISendChar(' ');
+        SCISendDec((j == 0) ? 0 : (word)1 << (j - 1));
+        SCISendStr((j == LATENCY_BINS - 1) ? "+ ms: " : " ms: ");
+        SCISendDec(hist[j]);
+    }
+    SCISendNewLine();
+}
+
+
+// report the latencies of every mode that has any on the SCI
+void LatencyReport(void)
+{
+    static char *names[] = { "Ready   ", "Avoid   ", "Line    ", "Combat  ", "Debug   ",
+#ifdef MAZE
+                             "Maze    "
+#endif
+                           };
+    byte i;
+
+    for (i = 0; i < MOUSE_MODES; i++) {
+        if (latencyCount[i] == 0 && latencyDropped[i] == 0) {
+            continue;
+        }
+        LatencyReportMode((MouseMode)i, names[i]);
+    }
+}
@@ -0,0 +1,144 @@
+///
+/// @file       load.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements measurement of the CPU load: an idle counter
+///             calibrated against the navigation period, and the busy time
+///             of each ISR.
+///
+/// @remarks    Every loop that waits for something (the ISRs, a touch bar,
+///             the SCI), and every mode loop between its passes, calls
+///             LoadIdle(). Its fixed spin takes far longer than the poll of
+///             any such loop, so a pass costs about the same in every loop.
+///             LoadCalibrate() counts the passes in one navigation period with
+///             interrupts disabled, i.e., with the CPU otherwise idle. The
+///             share of that count missing from a later period is the CPU
+///             load, which includes the work of the main loop as well as the
+///             ISRs. Each ISR is also timed in TPM2 counts from the event that
+///             raised it, i.e., the overflow or the capture, to LoadExit(), so
+///             that the interrupt latency and the entry before LoadEnter()
+///             count as well; if another ISR was still running when the event
+///             came, the time is counted from its end instead, so that nothing
+///             is counted twice.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#define LOAD_IDLE_SPINS     32  // iterations of the spin in one idle pass
+
+
+static volatile word loadIdleCount; // passes of idle loops; only ever incremented
+static word loadIdleLast;           // loadIdleCount at the last navigation period
+static word loadBusy[LOAD_SOURCES]; // TPM2 counts in each ISR in this navigation period
+static word loadExit;               // TPM2CNT at the end of the last timed ISR
+
+
+// TPM2 counts from 'from' to 'to', across a wrap of the counter
+static word Since(word from, word to)
+{
+    return (to >= from) ? to - from : to + (TPM2MOD + 1) - from;
+}
+
+
+// one pass of an idle loop; the ISR may read the count half-incremented,
+// which only moves 256 passes from one navigation period to the next
+void LoadIdle(void)
+{
+    volatile byte spin;
+
+    for (spin = 0; spin < LOAD_IDLE_SPINS; spin++) {
+    }
+    loadIdleCount++;
+}
+
+
+// count the idle passes in one navigation period; called from main() with
+// interrupts disabled, before the TPM2 ISRs are wanted
+void LoadCalibrate(void)
+{
+    byte tmp, ticks;
+    word start;
+
+    tmp = TPM2SC_TOF;   // start at the next overflow
+    TPM2SC_TOF = 0;
+    while (!TPM2SC_TOF) {
+    }
+
+    start = loadIdleCount;
+    for (ticks = 0; ticks < SCHED_TICKS(navigatePeriod); ticks++) {
+        tmp = TPM2SC_TOF;
+        TPM2SC_TOF = 0;
+        while (!TPM2SC_TOF) {
+            LoadIdle();
+        }
+    }
+    loadIdleMax = loadIdleCount - start;
+    loadIdleLast = loadIdleCount;
+
+    tmp = TPM2SC_TOF;   // leave the overflow to the ISR
+    TPM2SC_TOF = 0;
+}
+
+
+// start of an ISR raised at the TPM2 count 'event': the count from which it
+// keeps the CPU busy
+word LoadEnter(word event)
+{
+    word now = TPM2CNT;
+
+    if (Since(event, loadExit) < Since(event, now)) {
+        return loadExit;    // it waited for another ISR, which counted that time
+    }
+    return event;
+}
+
+
+// add the time since 'start' to the busy time of 'source'
+void LoadExit(LoadSource source, word start)
+{
+    word now = TPM2CNT;
+
+    loadBusy[source] += Since(start, now);
+    loadExit = now;
+}
+
+
+// close the measurement of a navigation period; called by TaskNavigate()
+void LoadPeriod(void)
+{
+    word idle = loadIdleCount - loadIdleLast;
+    byte i;
+
+    loadIdleLast += idle;
+    if (loadIdleMax != 0) {
+        loadPercent = (idle >= loadIdleMax) ? 0 : (byte)(100 - (dword)idle * 100 / loadIdleMax);
+    }
+    for (i = 0; i < LOAD_SOURCES; i++) {
+        loadIsrBusy[i] = loadBusy[i];
+        loadBusy[i] = 0;
+    }
+}
+
+
+// report the load of the last navigation period on the SCI
+void LoadReport(void)
+{
+    static char *names[] = { "TPM2OVF ", "TPM2CH0 ", "TPM2CH1 " };
+    byte i;
+
+    SCISendStr("CPU load ");
+    SCISendDec(loadPercent);
+    SCISendStr("%\r\n");
+    for (i = 0; i < LOAD_SOURCES; i++) {
+        SCISendStr(names[i]);
+        SCISendDec((word)((dword)loadIsrBusy[i] * 1000 / (((dword)TPM2_MOD + 1) * SCHED_TICKS(navigatePeriod))));
+        SCISendStr(" per mille\r\n");
+    }
+}
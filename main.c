@@ -68,8 +68,8 @@
 /// </tr>
 /// <tr>
 /// <td>busClock</td>
-/// <td>2</td>
-/// <td>system bus clock in MHz</td>
+/// <td>20</td>
+/// <td>system bus clock in MHz; set by CLOCK_PROFILE (CLOCK_2MHZ or CLOCK_20MHZ)</td>
 /// </tr>
 /// <tr>
 /// <td>pwmPeriod</td>
@@ -77,8 +77,13 @@
 /// <td>Period of PWM signal in ms</td>
 /// </tr>
 /// <tr>
+/// <td>tickPeriod</td>
+/// <td>1</td>
+/// <td>Period of the scheduler tick (TPM2 overflow) in ms</td>
+/// </tr>
+/// <tr>
 /// <td>controlPeriod</td>
-/// <td>50</td>
+/// <td>5</td>
 /// <td>Period of motor speed control in ms</td>
 /// </tr>
 /// <tr>
@@ -140,52 +145,18 @@
 
 
 #include "mouse.h"	// for the declaration of types, constants, variables and functions
+#ifdef __SDCC
+#include "vectors.h"	// the interrupt handlers, so that SDCC emits the vector table
+#endif
 
 
 void main(void)
 {
-    byte tbfr, tbfl, tbrr, tbrl;
+    byte tbfr, tbfl;
     
     DisableInterrupts;
-    SOPT = 0x00; //disable watchdog
-    
-    ICGC1 = 0b01110100; // select external crystal
-    Delay(64);  // start up delay for crystal
-    SCISetup(); // setup serial communication via RS-232 I/F
-    
-    //--------------------------------------------------------
-    // Initialization
-    //--------------------------------------------------------
-    // for motor driving with PWM from TPM1
-    TPM1SC = 0b00001000;    // edge-aligned PWM on bus clock
-    TPM1MOD = (word)(pwmPeriod * busClock * 1000);  // set PWM period
-    TPM1C2SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF0 (left motor IN_A)
-    TPM1C3SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF1 (left motor IN_B)
-    TPM1C4SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF2 (right motor IN_A)
-    TPM1C5SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF3 (right motor IN_B)
-
-    // for motor speed control with timer overflow interrupt of TPM2
-    TPM2SC = 0b01001000;    // enable timer overflow and input capture on bus rate clock
-    TPM2MOD = (word)(controlPeriod * busClock * 1000);  // set motor speed control period
-    TPM2C0SC = 0b01000100;  // enable interrups on positive edge for PTF4 (left tachometer)
-    TPM2C1SC = 0b01000100;  // enable interrups on positive edge for PTF5 (right tachometer)
-    diffLeft = 0;           // difference between two consecutive counter values for left motor
-    diffRight = 0;          // difference between two consecutive counter values for right motor
-    travelDistance = 0;     // distance to travel; one unit is approximately 05 mm
-    scaleFactor = 200;      // scale factor used in motor speed control
-    nomSpeed = 0x2000;      // nominal speed
-    pwLeft = defaultSpeed;  // PWM duty cycle for left motor
-    pwRight = defaultSpeed; // PWM duty cycle for right motor
-    pwMax = 90;             // maximum for PWM duty cycle
-    pwMin = 10;             // minimum for PWM duty cycle
-
-    // for ADC
-    ADC1CFG = 0b00000000;   // on bus clock, 8-bit conversion
-    APCTL1 = 0b11111111;    // use all 8 pins of port B for ADC
-
-    // for motor status
-    leftMotor = MOTOR_STATUS_STOP;
-    rightMotor = MOTOR_STATUS_STOP;
+    MouseSetup();   // initialise peripherals and control variables
+    LoadCalibrate();    // count idle loop passes while nothing else runs
 
     // now we are ready to go!
     EnableInterrupts;
@@ -204,24 +175,17 @@ void main(void)
     // ---------------------------------------------------------------------
     //
 
-    PTAPE = 0xFF;   // enable port A pullups for touchbar switches and infrared sensors
-    PTADD = 0x00;   // set port A as input
-
-/*
     tbfl = touchBarFrontLeft;
     tbfr = touchBarFrontRight;
-    */
-    tbfl = 0;
-    tbfr = 0;
     if ((tbfl == 0) && (tbfr == 0)) {
         mouseMode = MOUSE_MODE_DEBUG;
-        Test();
+        Debug();
     }
     else if ((tbfl == 0) && (tbfr == 1)) {
         mouseMode = MOUSE_MODE_COMBAT;
         Combat();
     }
-    else if ((tbrl == 1) && (tbrr == 0)) {
+    else if ((tbfl == 1) && (tbfr == 0)) {
         mouseMode = MOUSE_MODE_LINE_FOLLOWING;
         LineFollowing();
     }
@@ -231,6 +195,6 @@ void main(void)
     }
 
     for (;;) {
-        // do nothing; just waiting for interrupts
+        LoadIdle(); // do nothing; just waiting for interrupts
     }
 }
\ No newline at end of file
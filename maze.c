@@ -0,0 +1,315 @@
+///
+/// @file       maze.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the wall map and flood-fill solver for the maze mode.
+///
+/// @remarks    Cells are numbered (y << 4) | x with (0, 0) at the start corner
+///             and y increasing northwards. Each byte of mazeMap holds the walls
+///             of a cell (MAZE_NORTH .. MAZE_WEST) and MAZE_VISITED. Walls
+///             that have not been seen yet are treated as open.
+///             The search run floods towards the centre with MazeStep(); once
+///             there, MazeExploreStep() compares the shortest path with the
+///             unseen walls taken as open and as closed. While they differ,
+///             the mouse heads for the nearest unvisited cell on the first
+///             (marked MAZE_ON_PATH), as only those can change the fast run;
+///             once they agree, it goes back to the start. The return thus
+///             does the exploring, and the cells off every candidate path
+///             are left alone.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#ifdef MAZE
+
+#define FLOOD_GOAL      0   // targets of Flood()
+#define FLOOD_START     1
+#define FLOOD_MARKED    2   // the unvisited cells marked by MarkPath()
+
+
+static byte mazeQueue[MAZE_CELLS];  // cells waiting in the flood fill
+
+
+// cell next to 'cell' in direction 'dir'; the caller checks the maze border
+static byte Neighbour(byte cell, byte dir)
+{
+    switch (dir) {
+    case MAZE_DIR_NORTH:
+        return (byte)(cell + MAZE_SIZE);
+    case MAZE_DIR_EAST:
+        return (byte)(cell + 1);
+    case MAZE_DIR_SOUTH:
+        return (byte)(cell - MAZE_SIZE);
+    default:
+        return (byte)(cell - 1);
+    }
+}
+
+
+// clear the map and set the outer walls
+void MazeInit(void)
+{
+    word i;
+    byte x, y;
+
+    for (i = 0; i < MAZE_CELLS; i++) {
+        x = MAZE_X(i);
+        y = MAZE_Y(i);
+        mazeMap[i] = 0;
+        if (y == MAZE_SIZE - 1) {
+            mazeMap[i] |= MAZE_NORTH;
+        }
+        if (x == MAZE_SIZE - 1) {
+            mazeMap[i] |= MAZE_EAST;
+        }
+        if (y == 0) {
+            mazeMap[i] |= MAZE_SOUTH;
+        }
+        if (x == 0) {
+            mazeMap[i] |= MAZE_WEST;
+        }
+    }
+    mazeCell = MAZE_START;
+    mazeHeading = MAZE_DIR_NORTH;
+}
+
+
+// true if moving from 'cell' in direction 'dir' stays inside the maze
+byte MazeOnBoard(byte cell, byte dir)
+{
+    switch (dir) {
+    case MAZE_DIR_NORTH:
+        return MAZE_Y(cell) < MAZE_SIZE - 1;
+    case MAZE_DIR_EAST:
+        return MAZE_X(cell) < MAZE_SIZE - 1;
+    case MAZE_DIR_SOUTH:
+        return MAZE_Y(cell) > 0;
+    default:
+        return MAZE_X(cell) > 0;
+    }
+}
+
+
+// record the walls seen around a cell, and the same walls on its neighbours
+void MazeSetWalls(byte cell, byte walls)
+{
+    byte dir;
+
+    mazeMap[cell] |= (byte)((walls & MAZE_WALLS) | MAZE_VISITED);
+    for (dir = 0; dir < 4; dir++) {
+        if ((walls & MAZE_WALL(dir)) && MazeOnBoard(cell, dir)) {
+            mazeMap[Neighbour(cell, dir)] |= MAZE_WALL(MAZE_OPPOSITE(dir));
+        }
+    }
+}
+
+
+// true if 'cell' is one of the four centre cells
+byte MazeIsGoal(byte cell)
+{
+    byte x = MAZE_X(cell), y = MAZE_Y(cell);
+
+    return (x == MAZE_SIZE / 2 - 1 || x == MAZE_SIZE / 2)
+        && (y == MAZE_SIZE / 2 - 1 || y == MAZE_SIZE / 2);
+}
+
+
+// true if the side 'dir' of 'cell' is open; a 'pessimistic' flood only
+// goes through visited cells, as the fast run does
+static byte Open(byte cell, byte dir, byte pessimistic)
+{
+    if (mazeMap[cell] & MAZE_WALL(dir)) {
+        return 0;
+    }
+    return !pessimistic || ((mazeMap[cell] & MAZE_VISITED) && (mazeMap[Neighbour(cell, dir)] & MAZE_VISITED));
+}
+
+
+// fill mazeDist with the number of cells to the nearest cell of 'target'
+// (FLOOD_GOAL, FLOOD_START or FLOOD_MARKED)
+static void Flood(byte target, byte pessimistic)
+{
+    word i, head, tail;
+    byte cell, next, dir, dist, source;
+
+    tail = 0;
+    for (i = 0; i < MAZE_CELLS; i++) {
+        switch (target) {
+        case FLOOD_START:
+            source = (i == MAZE_START);
+            break;
+        case FLOOD_MARKED:
+            source = ((mazeMap[i] & (MAZE_ON_PATH | MAZE_VISITED)) == MAZE_ON_PATH);
+            break;
+        default:
+            source = MazeIsGoal((byte)i);
+            break;
+        }
+        if (source) {
+            mazeDist[i] = 0;
+            mazeQueue[tail++] = (byte)i;
+        }
+        else {
+            mazeDist[i] = MAZE_UNREACHED;
+        }
+    }
+
+    // breadth-first search; every cell enters the queue at most once
+    for (head = 0; head < tail; head++) {
+        cell = mazeQueue[head];
+        dist = (byte)(mazeDist[cell] + 1);
+        for (dir = 0; dir < 4; dir++) {
+            if (!Open(cell, dir, pessimistic)) {
+                continue;
+            }
+            next = Neighbour(cell, dir);
+            if (mazeDist[next] == MAZE_UNREACHED) {
+                mazeDist[next] = dist;
+                mazeQueue[tail++] = next;
+            }
+        }
+#ifdef MAZE_STATS
+        mazeCellUpdates++;
+#endif
+    }
+#ifdef MAZE_STATS
+    if (tail > mazeQueuePeak) {
+        mazeQueuePeak = tail;
+    }
+#endif
+}
+
+
+// fill mazeDist with the number of cells to the centre (toStart == 0) or to
+// the start cell (toStart != 0), going through the walls recorded so far
+void MazeFlood(byte toStart)
+{
+    Flood(toStart ? FLOOD_START : FLOOD_GOAL, 0);
+}
+
+
+// mark with MAZE_ON_PATH the cells on any shortest path from the start to
+// the centre in mazeDist; the queue of the flood fill is free again by now
+static void MarkPath(void)
+{
+    word i, head, tail;
+    byte cell, next, dir;
+
+    for (i = 0; i < MAZE_CELLS; i++) {
+        mazeMap[i] &= (byte)~MAZE_ON_PATH;
+    }
+    if (mazeDist[MAZE_START] == MAZE_UNREACHED) {
+        return;
+    }
+    mazeMap[MAZE_START] |= MAZE_ON_PATH;
+    mazeQueue[0] = MAZE_START;
+    tail = 1;
+    // every step of a shortest path goes one cell closer to the centre
+    for (head = 0; head < tail; head++) {
+        cell = mazeQueue[head];
+        for (dir = 0; dir < 4; dir++) {
+            if (mazeMap[cell] & MAZE_WALL(dir)) {
+                continue;
+            }
+            next = Neighbour(cell, dir);
+            if (mazeDist[next] + 1 == mazeDist[cell] && !(mazeMap[next] & MAZE_ON_PATH)) {
+                mazeMap[next] |= MAZE_ON_PATH;
+                mazeQueue[tail++] = next;
+            }
+        }
+    }
+}
+
+
+// true if the shortest path to the centre is known: it is as long with the
+// walls not seen yet taken as closed as with them taken as open. Otherwise,
+// the cells on the shortest paths with them taken as open are marked, and
+// the unvisited ones among them are worth exploring.
+byte MazePlan(void)
+{
+    byte pessimistic;
+
+    Flood(FLOOD_GOAL, 1);
+    pessimistic = mazeDist[MAZE_START];
+    Flood(FLOOD_GOAL, 0);
+    MarkPath();
+    return mazeDist[MAZE_START] == pessimistic;
+}
+
+
+// direction of the open neighbour of mazeCell with the smallest distance;
+// straight ahead wins ties to save turns
+byte MazeNextDirection(void)
+{
+    byte dir, best, bestDist, next;
+
+    best = mazeHeading;
+    bestDist = MAZE_UNREACHED;
+    for (dir = 0; dir < 4; dir++) {
+        if (mazeMap[mazeCell] & MAZE_WALL(dir)) {
+            continue;
+        }
+        next = Neighbour(mazeCell, dir);
+        if (mazeDist[next] < bestDist || (mazeDist[next] == bestDist && dir == mazeHeading)) {
+            best = dir;
+            bestDist = mazeDist[next];
+        }
+    }
+    return best;
+}
+
+
+// move mazeCell one cell in direction 'dir'
+void MazeMove(byte dir)
+{
+    mazeCell = Neighbour(mazeCell, dir);
+    mazeHeading = dir;
+}
+
+
+// one step of the search run: record the walls seen in mazeCell, flood the
+// map, and return the direction to move next (which is also applied to
+// mazeCell and mazeHeading)
+byte MazeStep(byte walls, byte toStart)
+{
+    byte dir;
+
+    MazeSetWalls(mazeCell, walls);
+    MazeFlood(toStart);
+    dir = MazeNextDirection();
+    MazeMove(dir);
+    return dir;
+}
+
+
+// one step of the exploration after the centre has been reached: record the
+// walls seen in mazeCell, and head for the nearest cell that may still make
+// the shortest path shorter, or for the start once it is known, exploring
+// what lies on the way; returns the direction like MazeStep()
+byte MazeExploreStep(byte walls)
+{
+    byte dir;
+
+    MazeSetWalls(mazeCell, walls);
+    if (MazePlan()) {
+        Flood(FLOOD_START, 0);
+    }
+    else {
+        Flood(FLOOD_MARKED, 0);
+        if (mazeDist[mazeCell] == MAZE_UNREACHED) {
+            Flood(FLOOD_START, 0);  // walled off from what is left; go home
+        }
+    }
+    dir = MazeNextDirection();
+    MazeMove(dir);
+    return dir;
+}
+
+#endif  // MAZE
@@ -0,0 +1,279 @@
+///
+/// @file       model.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the motor models behind the feed-forward of the
+///             speed controller, and their identification from step
+///             responses.
+///
+/// @remarks    The model of a motor gives the duty cycle for a wheel speed
+///             and acceleration as friction + velocity * speed + accel *
+///             acceleration, with speeds in tachometer pulses per second.
+///             ControlSpeed() adds it to the output of its feedback, so that
+///             the feedback only has to correct the errors of the model, and
+///             ramps the reference speed no faster than the models say the
+///             motors can follow. ModelIdentify() drives both motors open loop
+///             through MODEL_STEPS duty cycle steps; each step gives a point
+///             of the steady-state line duty = friction + velocity * speed,
+///             fitted by least squares, and the area between the response
+///             and its final speed gives the time constant, i.e., accel =
+///             velocity * time constant. Lift the mouse, or give it a metre
+///             of straight floor.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static const byte modelDuty[MODEL_STEPS] = { 20, 35, 50, 65, 80 };  // duty cycle of each step
+
+// state of the identification, per motor
+static byte modelStep;          // step being driven
+static byte modelPeriods;       // control periods into the step
+static word modelTach[2];       // tachCount at the start of the step
+static word modelStart[2];      // speed at the start of the step
+static long modelSum[2];        // sum of the speeds over the step
+static long modelTail[2];       // sum of the speeds over the last MODEL_TAIL periods of the step
+static word modelFinal[2][MODEL_STEPS];     // final speed of each step
+static dword modelTau[2];       // sum of up to MODEL_STEPS time constants in control periods, Q8.8
+static byte modelTaus[2];       // number of time constants in modelTau
+
+
+// load the default models; the feedback of a motor without a model starts
+// from the start-up duty cycle, as it did without feed-forward
+void ModelInit(void)
+{
+    byte i;
+
+    for (i = 0; i < 2; i++) {
+        motorModel[i].friction = defaultModelFriction;
+        motorModel[i].velocity = defaultModelVelocity;
+        motorModel[i].accel = defaultModelAccel;
+    }
+    trimLeft = (motorModel[MOTOR_LEFT].velocity != 0) ? 0 : (int)pwLeft;
+    trimRight = (motorModel[MOTOR_RIGHT].velocity != 0) ? 0 : (int)pwRight;
+    speedReference = 0;
+    modelIdentifying = 0;
+}
+
+
+// wheel speed in tachometer pulses per second for a tachometer period in TPM2 counts
+word ModelSpeed(word period)
+{
+    if (period == 0) {
+        return 0;
+    }
+    return (word)(TPM2_HZ / period);
+}
+
+
+// duty cycle in percent that drives 'motor' at 'speed' while accelerating at
+// 'accel' (pulses per second squared); not limited to [pwMin, pwMax]
+int ModelDuty(Motor motor, word speed, long accel)
+{
+    const MotorModel *m = &motorModel[motor];
+    long duty;
+
+    if (speed == 0 && accel <= 0) {
+        return 0;
+    }
+    duty = ((long)m->velocity * speed + (long)m->accel * accel + 0x8000L) >> 16;
+    return (int)duty + m->friction;
+}
+
+
+// reference speed for the next control period: 'to', or as close to it as
+// the duty cycle left between pwMin and pwMax at 'to' can accelerate both
+// motors
+word ModelRamp(word from, word to)
+{
+    byte i;
+    int headroom;
+    long step, limit = 0x7FFFFFFFL;
+
+    for (i = 0; i < 2; i++) {
+        if (motorModel[i].accel == 0) {
+            continue;   // no inertia in the model
+        }
+        headroom = ModelDuty((Motor)i, to, 0);
+        headroom = (to > from) ? (int)pwMax - headroom : headroom - (int)pwMin;
+        if (headroom <= 0) {
+            return to;  // the model cannot help; leave it to the feedback
+        }
+        step = ((long)headroom << 16) / ((long)motorModel[i].accel * (1000 / controlPeriod));
+        if (step < limit) {
+            limit = (step > 0) ? step : 1;
+        }
+    }
+    if (to > from) {
+        return ((long)(to - from) > limit) ? (word)(from + limit) : to;
+    }
+    return ((long)(from - to) > limit) ? (word)(from - limit) : to;
+}
+
+
+//------------------------------------------------------------------------------
+// Identification
+//------------------------------------------------------------------------------
+// start the identification; TaskControl() steps it instead of ControlSpeed()
+void ModelIdentify(void)
+{
+    byte i;
+
+    MotionClear();
+    for (i = 0; i < 2; i++) {
+        modelTau[i] = 0;
+        modelTaus[i] = 0;
+    }
+    modelStep = 0;
+    modelPeriods = 0;
+    modelIdentifying = 1;
+}
+
+
+// speed of 'motor' in pulses/s; the speed at the start of the step until
+// two pulses have come in the step
+static word StepSpeed(Motor motor)
+{
+    if ((word)(tachCount[motor] - modelTach[motor]) < 2) {
+        return modelStart[motor];
+    }
+    return ModelSpeed((motor == MOTOR_LEFT) ? diffLeft : diffRight);
+}
+
+
+// fit the steady-state line and the time constant of 'motor'
+static void Fit(Motor motor)
+{
+    byte i, n = 0;
+    long sumDuty = 0, sumSpeed = 0, sdv = 0, svv = 0, dv, vv;
+    Q16_16 velocity;
+    int friction;
+
+    // steps below the static friction, where the motor stood still, are left out
+    for (i = 0; i < MODEL_STEPS; i++) {
+        if (modelFinal[motor][i] != 0) {
+            sumDuty += modelDuty[i];
+            sumSpeed += modelFinal[motor][i];
+            n++;
+        }
+    }
+    if (n < 2) {
+        return;     // no tachometer; keep the model
+    }
+    for (i = 0; i < MODEL_STEPS; i++) {
+        if (modelFinal[motor][i] != 0) {
+            dv = (long)modelDuty[i] * n - sumDuty;
+            vv = (long)modelFinal[motor][i] * n - sumSpeed;
+            sdv += dv * vv;
+            svv += vv * vv;
+        }
+    }
+
+    velocity = FixDiv16(sdv, svv);  // percent per pulse/s, Q16.16
+    if (velocity <= 0 || velocity > 0xFFFFL) {
+        return;
+    }
+    friction = (int)((sumDuty - ((velocity * sumSpeed + 0x8000L) >> 16)) / n);
+    motorModel[motor].velocity = (word)velocity;
+    motorModel[motor].friction = (byte)((friction > 0) ? friction : 0);
+    if (modelTaus[motor] != 0) {
+        // time constant in s times the velocity gain
+        motorModel[motor].accel = (word)(((dword)velocity * (modelTau[motor] / modelTaus[motor])
+                                          * controlPeriod / 1000) >> 8);
+    }
+}
+
+
+// close a step of 'motor': its final speed and its time constant
+static void EndStep(Motor motor)
+{
+    word final = (word)(modelTail[motor] / MODEL_TAIL);
+    long area;
+
+    modelFinal[motor][modelStep] = final;
+    if (final > modelStart[motor] + MODEL_RISE) {
+        // the area between the response and its final speed, over the rise,
+        // is the time constant of a first-order response
+        area = (long)final * MODEL_PERIODS - modelSum[motor];
+        if (area > 0) {
+            modelTau[motor] += (dword)((area << 8) / (final - modelStart[motor]));
+            modelTaus[motor]++;
+        }
+    }
+    modelStart[motor] = final;
+}
+
+
+// one control period of the identification; called by TaskControl()
+void ModelIdentifyStep(void)
+{
+    byte i;
+    word v;
+
+    if (modelPeriods == 0) {
+        // next step: open loop at the step's duty cycle
+        pwLeft = pwRight = modelDuty[modelStep];
+        ControlMotor(MOTOR_LEFT, MOTOR_ACTION_FORWARD);
+        ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_FORWARD);
+        for (i = 0; i < 2; i++) {
+            if (modelStep == 0) {
+                modelStart[i] = 0;
+            }
+            modelTach[i] = tachCount[i];
+            modelSum[i] = 0;
+            modelTail[i] = 0;
+        }
+    }
+
+    for (i = 0; i < 2; i++) {
+        v = StepSpeed((Motor)i);
+        modelSum[i] += v;
+        if (modelPeriods >= MODEL_PERIODS - MODEL_TAIL) {
+            modelTail[i] += v;
+        }
+    }
+
+    if (++modelPeriods < MODEL_PERIODS) {
+        return;
+    }
+    modelPeriods = 0;
+    for (i = 0; i < 2; i++) {
+        EndStep((Motor)i);
+    }
+    if (++modelStep < MODEL_STEPS) {
+        return;
+    }
+
+    ControlMotor(MOTOR_LEFT, MOTOR_ACTION_STOP);
+    ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_STOP);
+    for (i = 0; i < 2; i++) {
+        Fit((Motor)i);
+    }
+    trimLeft = trimRight = 0;
+    modelIdentifying = 0;
+}
+
+
+// report the models on the SCI
+void ModelReport(void)
+{
+    static char *names[] = { "Left  ", "Right " };
+    byte i;
+
+    for (i = 0; i < 2; i++) {
+        SCISendStr(names[i]);
+        SCISendStr("friction ");
+        SCISendDec(motorModel[i].friction);
+        SCISendStr(" %, velocity ");
+        SCISendDec(motorModel[i].velocity);
+        SCISendStr(", accel ");
+        SCISendDec(motorModel[i].accel);
+        SCISendStr(" (1/65536 %)\r\n");
+    }
+}
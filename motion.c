@@ -0,0 +1,124 @@
+///
+/// @file       motion.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the motion command queue executed by the TPM2
+///             interrupts.
+///
+/// @remarks    Mode code pushes commands with MotionPush() and carries on
+///             planning; MotionService() starts the next command as soon as
+///             the current one has finished, without stopping in between.
+///             The queue has a single producer (the main loop) and a single
+///             consumer (the ISRs), so head and tail are each written by one
+///             side only and no interrupt masking is needed.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static MotionCommand motionQueue[MOTION_QUEUE_SIZE];
+static volatile byte motionHead;    // next command to execute; written by the ISRs
+static volatile byte motionTail;    // next free entry; written by the main loop
+static volatile byte motionBusy;    // a command is being executed
+static volatile int motionHold;     // navigation periods left of a MOTION_STOP
+
+
+// start a command
+static void Start(const MotionCommand *cmd)
+{
+    switch (cmd->type) {
+    case MOTION_MOVE:
+        travelDistance = GeometryMove(cmd->amount);
+        ControlMouse(cmd->amount < 0 ? MOUSE_ACTION_REVERSE : MOUSE_ACTION_FORWARD);
+        break;
+    case MOTION_TURN:
+        travelDistance = GeometryTurn(cmd->amount);
+        ControlMouse(cmd->amount < 0 ? MOUSE_ACTION_TURNAROUND : MOUSE_ACTION_ROTATELEFT);
+        break;
+    case MOTION_ARC:
+        travelDistance = GeometryArc(cmd->amount, cmd->amount < 0 ? -MOTION_ARC_RADIUS : MOTION_ARC_RADIUS);
+        ControlArc(cmd->amount < 0 ? -MOTION_ARC_RADIUS : MOTION_ARC_RADIUS);
+        break;
+    case MOTION_STOP:
+        travelDistance = 0;
+        motionHold = cmd->amount;
+        ControlMouse(MOUSE_ACTION_BRAKE);   // shorter than coasting to a stop
+        break;
+    }
+}
+
+
+// has the command being executed finished?
+static byte Finished(void)
+{
+    if (motionQueue[motionHead].type == MOTION_STOP) {
+        return motionHold <= 0;
+    }
+    return travelDistance == 0;
+}
+
+
+// append a command; returns 0 if the queue is full
+byte MotionPush(MotionType type, int amount)
+{
+    byte next = (byte)((motionTail + 1) & (MOTION_QUEUE_SIZE - 1));
+
+    if (next == motionHead) {
+        return 0;
+    }
+    motionQueue[motionTail].type = type;
+    motionQueue[motionTail].amount = amount;
+    motionTail = next;  // publish the command only after it is complete
+    return 1;
+}
+
+
+// true when all commands have been executed
+byte MotionIdle(void)
+{
+    return !motionBusy && motionHead == motionTail;
+}
+
+
+// drop all commands and stop the mouse
+void MotionClear(void)
+{
+    DisableInterrupts;
+    motionHead = motionTail;
+    motionBusy = 0;
+    travelDistance = 0;
+    ControlMouse(MOUSE_ACTION_STOP);
+    EnableInterrupts;
+}
+
+
+// advance the queue; called by TaskNavigate(), i.e., every navigation period,
+// and by the tachometer ISRs whenever travelDistance runs out
+void MotionService(byte tick)
+{
+    if (motionBusy) {
+        if (tick && motionQueue[motionHead].type == MOTION_STOP) {
+            motionHold--;
+        }
+        if (!Finished()) {
+            return;
+        }
+        motionHead = (byte)((motionHead + 1) & (MOTION_QUEUE_SIZE - 1));
+        motionBusy = 0;
+        if (motionHead == motionTail) {
+            ControlMouse(MOUSE_ACTION_STOP);    // nothing left to do
+            return;
+        }
+    }
+
+    if (motionHead != motionTail) {
+        Start(&motionQueue[motionHead]);
+        motionBusy = 1;
+    }
+}
@@ -19,17 +19,47 @@
 #include "mouse.h"	// for the declaration of types, constants, variables and functions
 
 
-void ControlMotor(Motor motor, MotorAction action)
+// state of the reversals, per motor
+static MotorStatus motorDirection[2];   // direction that the motor was last driven in; MOTOR_STATUS_STOP if none
+static MotorAction motorPending[2];     // direction to drive in once the wheel stands still
+static byte motorBraking[2];            // control periods of braking for a reversal, counting from 1; 0 if none
+static word motorTach[2];               // tachCount in the last control period
+static byte motorIdle[2];               // control periods since the last tachometer pulse
+
+// period errors carried over by the integral feedback of ControlSpeed()
+static long balanceRest;
+static long speedRest;
+
+
+// no reversal under way, both motors stand still, and no error is carried over
+void ControlInit(void)
+{
+    byte i;
+
+    for (i = 0; i < 2; i++) {
+        motorDirection[i] = MOTOR_STATUS_STOP;
+        motorBraking[i] = 0;
+        motorTach[i] = tachCount[i];
+        motorIdle[i] = 0xFF;
+    }
+    balanceRest = 0;
+    speedRest = 0;
+}
+
+
+// set the H-bridge of a motor for 'action' at once
+static void SetBridge(Motor motor, MotorAction action)
 {
     MotorStatus status;
     word pwm, tpm1, tpm2;
     // holding values to be transferred to TPM registers (TPM1C2V/TPM1C3V or TPM1C4V/TPM1C5V)
     
+    // pwLeft and pwRight are duty cycles at batteryNominal; scale them for the actual battery voltage
     if (motor == MOTOR_LEFT) {
-        pwm = (word)((100-pwLeft)*(TPM1MOD/100));	// duty cycle is for the 'off' period due to H bridge configuration
+        pwm = (word)((100-BatteryDuty(pwLeft))*(TPM1MOD/100));	// duty cycle is for the 'off' period due to H bridge configuration
     }
     else {        
-        pwm = (word)((100-pwRight)*(TPM1MOD/100));	// duty cycle is for the 'off' period due to H bridge configuration
+        pwm = (word)((100-BatteryDuty(pwRight))*(TPM1MOD/100));	// duty cycle is for the 'off' period due to H bridge configuration
     }
     
     switch (action) {
@@ -47,95 +77,259 @@ void ControlMotor(Motor motor, MotorAction action)
         tpm1 = LOW_WORD;
         tpm2 = LOW_WORD;
         status = MOTOR_STATUS_BRAKE;
+        speedReference = 0;     // the feed-forward restarts from standstill
         break;
     case MOTOR_ACTION_STOP:
         tpm1 = HIGH_WORD;
         tpm2 = HIGH_WORD;
         status = MOTOR_STATUS_STOP;
+        speedReference = 0;
         break;
+    default:
+        return;     // not an action of a single motor
     }
 
     if (motor == MOTOR_LEFT) {
+        if (TPM1C2V != tpm1 || TPM1C3V != tpm2) {
+            LatencyWrite(status != leftMotor);
+        }
         TPM1C2V=tpm1;
         TPM1C3V=tpm2;
         leftMotor = status;
     } else {
+        if (TPM1C4V != tpm1 || TPM1C5V != tpm2) {
+            LatencyWrite(status != rightMotor);
+        }
         TPM1C4V=tpm1;
         TPM1C5V=tpm2;
         rightMotor= status;
     }
+    if (status == MOTOR_STATUS_FORWARD || status == MOTOR_STATUS_REVERSE) {
+        motorDirection[motor] = status;
+    }
+}
+
+
+// drive, brake or stop a motor. A motor that is told to turn the other way
+// while its wheel still turns is braked first, by shorting it through both
+// low-side switches; ControlReversal() drives it the new way once the wheel
+// stands still, or after REVERSE_BRAKE_MAX control periods at the most.
+void ControlMotor(Motor motor, MotorAction action)
+{
+    if (action == MOTOR_ACTION_FORWARD || action == MOTOR_ACTION_REVERSE) {
+        if (motorBraking[motor] != 0) {
+            if (action == motorPending[motor]) {
+                return;     // on its way already
+            }
+            motorBraking[motor] = 0;    // the old direction again; no need to wait
+        }
+        else if (motorIdle[motor] < REVERSE_STILL
+                 && motorDirection[motor] == ((action == MOTOR_ACTION_FORWARD) ? MOTOR_STATUS_REVERSE : MOTOR_STATUS_FORWARD)) {
+            motorPending[motor] = action;
+            motorBraking[motor] = 1;
+            action = MOTOR_ACTION_BRAKE;
+        }
+    }
+    else {
+        motorBraking[motor] = 0;
+    }
+    SetBridge(motor, action);
+}
+
+
+// follow the tachometers, and finish the reversals that wait for a wheel to
+// stand still; called by TaskControl() in every control period
+void ControlReversal(void)
+{
+    byte i;
+
+    for (i = 0; i < 2; i++) {
+        if (tachCount[i] != motorTach[i]) {
+            motorTach[i] = tachCount[i];
+            motorIdle[i] = 0;
+        }
+        else if (motorIdle[i] != 0xFF) {
+            motorIdle[i]++;
+        }
+
+        if (motorBraking[i] == 0) {
+            continue;
+        }
+        if (motorIdle[i] >= REVERSE_STILL || motorBraking[i] >= REVERSE_BRAKE_MAX) {
+            motorBraking[i] = 0;
+            SetBridge((Motor)i, motorPending[i]);
+        }
+        else {
+            motorBraking[i]++;
+        }
+    }
+}
+
+
+
+
+// limit a correction of PWM duty cycle to +/- speedStep
+static int LimitStep(long corr)
+{
+    if (corr > (long)speedStep) {
+        return (int)speedStep;
+    }
+    else if (corr < -(long)speedStep) {
+        return -(int)speedStep;
+    }
+    return (int)corr;
+}
+
+
+// the step of an integral correction for a period error 'diff'. With the
+// proportional feedback on, the part of the error that is too small for a
+// step is carried over in 'rest', so that errors smaller than scaleFactor add
+// up; the pure integral feedback of the default gains was tuned with the dead
+// band that dropping it gives, and relies on it for damping.
+static int Integrate(long diff, long *rest)
+{
+    long sum = diff + *rest;
+    long step = sum / scaleFactor;
+
+    *rest = (speedGain != 0) ? sum - step * scaleFactor : 0;
+    return LimitStep(step);
+}
+
+
+// keep the feedback part of a duty cycle within what leaves [pwMin, pwMax]
+// at the steady-state duty cycle 'feed' of the motor model
+static int LimitTrim(int trim, int feed)
+{
+    if (trim > (int)pwMax - feed) {
+        return (int)pwMax - feed;
+    }
+    else if (trim < (int)pwMin - feed) {
+        return (int)pwMin - feed;
+    }
+    return trim;
+}
+
+
+// speed in pulses/s to take off the left wheel's target and to add to the
+// right wheel's on an arc of arcRadius at the reference 'speed'; the wheels
+// run half the track width inside and outside the arc
+static int ArcOffset(word speed)
+{
+    int radius = (arcRadius < 0) ? -arcRadius : arcRadius;
+    long offset, limit = (long)(speed - (speed >> MOTION_ARC_INNER));
+
+    offset = (radius != 0) ? (long)speed * trackWidth / (20L * radius) : limit;    // trackWidth in 0.1 mm
+    if (offset > limit) {
+        offset = limit;
+    }
+    return (arcRadius < 0) ? -(int)offset : (int)offset;
 }
 
 
 // main speed control function called by TPM2 timer overflow ISR
 void ControlSpeed(void)
 {
-    //int diff;
-    word tmpLeft, tmpRight;
+    long diff, accel = 0;
+    int tmpLeft, tmpRight, wall = 0, offset;
+    word speed = 0, speedLeft, speedRight;
+    long periodLeft, periodRight;
+    int step;
+    byte steady;
 
-    /*
-    diff = (int)diffLeft - (int)diffRight;
-    
-    if (diff != 0) {
-        // adjust the speeds of left and right motors based on the difference
-        //diff = diff / scaleFactor;
-        diff /= 65535;
-        tmpLeft = pwLeft - (word)diff;
-        tmpRight = pwRight + (word)diff;
-    */
-
-    /*    
-    if (diffLeft > diffRight) {
-        diff = ((int)(diffLeft - diffRight));
-        tmpLeft -= 2;
-        tmpRight += 2;
+    // the feed-forward of the motor models drives at a reference speed that
+    // ramps towards nomSpeed as fast as the models say the motors can follow
+    if (nomSpeed > 0) {
+        speed = ModelRamp(speedReference, ModelSpeed((word)nomSpeed));
+        accel = ((long)speed - (long)speedReference) * (1000 / controlPeriod);
+    }
+
+    // an arc sets the speed targets of the wheels apart for its curvature;
+    // on a straight, the heading hold does to steer back onto the heading of
+    // the straight, and while the walls steer, their heading is the one to hold
+    if (mouseStatus == MOUSE_STATUS_ARC) {
+        offset = ArcOffset(speed);
     }
     else {
-        diff = ((int)(diffRight - diffLeft));
-        tmpLeft = pwLeft + (word)diff;
-        tmpRight = pwRight - (word)diff;        
-    }
-    */
-    if (diffLeft > diffRight) {
-        tmpLeft = pwLeft - 2;
-        tmpRight = pwRight + 2;
-    }
-    if (diffLeft < diffRight) {
-        tmpLeft = pwLeft + 2;
-        tmpRight = pwRight - 2;      
-    }
-     
-    /*     
-	// if the new value is greater than pwMax or smaller than pwMin, recover the original value from TPM1 channel value register;
-	// otherwise, update the rigster with the new value.
-	if (tmpLeft >= pwMin && tmpLeft <= pwMax) {
-		pwLeft = tmpLeft;
-	}
-	if (tmpRight >= pwMin && tmpRight <= pwMax) {
-		pwRight = tmpRight;
-	}
-	*/
-	if (tmpLeft >= pwMax) {
+        wall = WallCorrection();
+        if (wall != 0) {
+            HeadingReset();
+        }
+        offset = HeadingOffset(speed);
+    }
+    speedLeft = (word)((int)speed - offset);
+    speedRight = (word)((int)speed + offset);
+    periodLeft = (long)ModelSpeed(speedLeft);      // tachometer periods of the targets
+    periodRight = (long)ModelSpeed(speedRight);
+
+    // a wheel without traction gets less torque, not more
+    if (wheelState[MOTOR_LEFT] & WHEEL_SLIP) {
+        trimLeft -= (int)speedStep;
+    }
+    if (wheelState[MOTOR_RIGHT] & WHEEL_SLIP) {
+        trimRight -= (int)speedStep;
+    }
+
+    // the tachometer periods lag behind a ramp, and are stale at a start, so
+    // the feedback waits until the reference has got to nomSpeed; it does not
+    // try to make up for a wheel that slips or stalls, either
+    steady = (nomSpeed <= 0 || speed == ModelSpeed((word)nomSpeed))
+             && (wheelState[MOTOR_LEFT] | wheelState[MOTOR_RIGHT]) == 0;
+    if (steady) {
+        // balance the motors; note that diffLeft and diffRight are tachometer
+        // periods, so the motor with the larger value is the slower one. The
+        // balance is offset by the periods of the targets, and between walls
+        // to steer towards the middle.
+        diff = (long)diffLeft - (long)diffRight - wall - (periodLeft - periodRight);
+        step = Integrate(diff, &balanceRest);
+        trimLeft += step;
+        trimRight -= step;
+
+        // then move both motors towards the nominal speed; on an arc, the
+        // mean of the periods is longer than the period of the mean speed
+        if (nomSpeed > 0) {
+            diff = ((long)diffLeft + (long)diffRight) / 2
+                   - ((mouseStatus == MOUSE_STATUS_ARC) ? (periodLeft + periodRight) / 2 : nomSpeed);
+            step = Integrate(diff, &speedRest);
+            trimLeft += step;
+            trimRight += step;
+        }
+    }
+    speedReference = speed;
+
+    // the feedback corrects the errors of the models only
+    trimLeft = LimitTrim(trimLeft, ModelDuty(MOTOR_LEFT, speed, 0));
+    trimRight = LimitTrim(trimRight, ModelDuty(MOTOR_RIGHT, speed, 0));
+    tmpLeft = trimLeft + ModelDuty(MOTOR_LEFT, speedLeft, accel);
+    tmpRight = trimRight + ModelDuty(MOTOR_RIGHT, speedRight, accel);
+
+    // the proportional part of the feedback acts on the speed errors at once
+    if (steady && speedGain != 0 && speed != 0) {
+        tmpLeft += (int)(((long)speedGain * ((long)speedLeft - (long)wheelSpeed[MOTOR_LEFT])) >> 8);
+        tmpRight += (int)(((long)speedGain * ((long)speedRight - (long)wheelSpeed[MOTOR_RIGHT])) >> 8);
+    }
+
+	// keep the new values within [pwMin, pwMax]
+	if (tmpLeft >= (int)pwMax) {
 		pwLeft = pwMax;
 	}
-	else if (tmpLeft <= pwMin) 
+	else if (tmpLeft <= (int)pwMin) 
 	{
 	    pwLeft = pwMin;
 	}
 	else 
 	{
-	    pwLeft = tmpLeft;
+	    pwLeft = (word)tmpLeft;
 	}
-	if (tmpRight >= pwMax) {
+	if (tmpRight >= (int)pwMax) {
 		pwRight = pwMax;
 	}
-	else if (tmpRight <= pwMin) 
+	else if (tmpRight <= (int)pwMin) 
 	{
 	    pwRight = pwMin;
 	}
 	else 
 	{
-	    pwRight = tmpRight;
+	    pwRight = (word)tmpRight;
 	}
 
 	// finally call ControlMotor() to reflect the changed values of pwLeft and pwRight in PWM.
@@ -41,7 +41,11 @@ typedef enum {
     MOUSE_MODE_OBSTACLE_AVOIDING,
     MOUSE_MODE_LINE_FOLLOWING,
     MOUSE_MODE_COMBAT,
-    MOUSE_MODE_DEBUG
+    MOUSE_MODE_DEBUG,
+#ifdef MAZE
+    MOUSE_MODE_MAZE,        ///< search run and exploration; Debug 'Z'
+#endif
+    MOUSE_MODES             ///< number of modes
 } MouseMode;
 
 typedef enum {
@@ -51,7 +55,9 @@ typedef enum {
     MOUSE_STATUS_STOP,
     MOUSE_STATUS_TURNLEFT,
     MOUSE_STATUS_TURNRIGHT,
-    MOUSE_STATUS_TURNAROUND
+    MOUSE_STATUS_TURNAROUND,
+    MOUSE_STATUS_ROTATELEFT,
+    MOUSE_STATUS_ARC            ///< both wheels forward along an arc of arcRadius
 } MouseStatus;
 
 typedef enum {
@@ -61,9 +67,38 @@ typedef enum {
     MOUSE_ACTION_STOP,
     MOUSE_ACTION_TURNLEFT,
     MOUSE_ACTION_TURNRIGHT,
-    MOUSE_ACTION_TURNAROUND
+    MOUSE_ACTION_TURNAROUND,    ///< rotate clockwise in place
+    MOUSE_ACTION_ROTATELEFT     ///< rotate anticlockwise in place
 } MouseAction;
 
+typedef enum {
+    MOTION_MOVE,    ///< move 'amount' mm; negative to reverse
+    MOTION_TURN,    ///< rotate in place by 'amount' degrees; positive is anticlockwise
+    MOTION_ARC,     ///< turn by 'amount' degrees along an arc of MOTION_ARC_RADIUS; positive is to the left
+    MOTION_STOP     ///< stop and hold for 'amount' navigation periods
+} MotionType;
+
+typedef struct {
+    MotionType type;
+    int amount;
+} MotionCommand;
+
+typedef enum {
+    COMBAT_OFF,         ///< not fighting; the motors are left alone
+    COMBAT_SEARCH,      ///< nothing seen; rotate towards where the opponent was last
+    COMBAT_TRACK,       ///< one IR sensor sees the opponent; arc towards it
+    COMBAT_CHARGE,      ///< both IR sensors see it; full duty cycle straight at it
+    COMBAT_PUSH,        ///< a front touch bar is on it; push in bursts
+    COMBAT_EVADE        ///< hit from behind or pushed; get away before turning round
+} CombatState;
+
+typedef struct {
+    byte type;          ///< PATH_* segment type, with PATH_RIGHT for turns to the right
+    byte length;        ///< half cells for straights, diagonal steps for diagonals
+    byte entrySpeed;    ///< speed at the start of the segment in PATH_SPEED_UNIT
+    byte exitSpeed;     ///< speed at the end of the segment in PATH_SPEED_UNIT
+} PathSegment;
+
 typedef enum {
     MOTOR_LEFT,
     MOTOR_RIGHT
@@ -83,6 +118,43 @@ typedef enum {
     MOTOR_ACTION_STOP
 } MotorAction;
 
+typedef struct {
+    byte friction;      ///< duty cycle in percent that overcomes static friction
+    word velocity;      ///< duty cycle per speed in 1/65536 % per tachometer pulse/s
+    word accel;         ///< duty cycle per acceleration in 1/65536 % per tachometer pulse/s^2
+} MotorModel;
+
+typedef struct {
+    byte input;         ///< INPUT_* bit of the input that changed
+    byte active;        ///< 1 if it became active (touched, detected, pressed)
+    word time;          ///< inputTime when the change was accepted
+    word start;         ///< schedTicks of the first sample that saw the change
+} InputEvent;
+
+typedef enum {
+    LOAD_TPM2OVF,
+    LOAD_TPM2CH0,
+    LOAD_TPM2CH1,
+    LOAD_SOURCES        ///< number of timed ISRs
+} LoadSource;
+
+typedef enum {
+    SCHED_SENSE,        ///< wall sensing
+    SCHED_INPUT,        ///< debounced inputs
+    SCHED_CONTROL,      ///< motor speed control
+    SCHED_NAVIGATE,     ///< motion commands, CPU load and stack checks
+    SCHED_TASKS         ///< number of scheduled tasks
+} SchedTask;
+
+#ifdef HOST_TARGET_WIDTHS
+typedef int16_t Q8_8;   // the host tools compute in the widths of the target
+typedef int32_t Q16_16;
+#else
+typedef int Q8_8;       ///< signed fixed point with 8 fractional bits
+typedef long Q16_16;    ///< signed fixed point with 16 fractional bits
+#endif
+typedef word Angle;     ///< binary angle; 0x10000 is a full turn, anticlockwise
+
 
 //------------------------------------------------------------------------------
 //  Macros and global constants
@@ -103,6 +175,40 @@ typedef enum {
 #define infraredFrontRight  PTAD_PTAD6
 //@}
 
+/// @name Analog IR sensors
+/// We assume that the receivers of the front IR sensors are also connected
+/// to PTB5 (left) and PTB4 (right), and that PTC4 switches their emitters.
+//@{
+#define infraredAnalogLeft  0x05    ///< ADC channel
+#define infraredAnalogRight 0x04    ///< ADC channel
+#define infraredEmitter     PTCD_PTCD4
+#define infraredEmitterMask 0x10    ///< bit of infraredEmitter in PTCDD
+//@}
+
+/// @name Battery
+/// We assume that PTB6 senses the battery through a 3:1 divider.
+//@{
+#define batteryChannel      0x06    ///< ADC channel
+#define batteryDivider      3       ///< ratio of the battery voltage to the voltage at batteryChannel
+#define adcReference        3300    ///< ADC reference (VREFH) in mV
+//@}
+
+/// @name Debounced digital inputs
+/// Bits of inputLevels and InputEvent.input; 1 is active for every input.
+/// Line following sensors are read through the ADC and are not included.
+//@{
+#define INPUT_TOUCH_FRONT_LEFT  0x01
+#define INPUT_TOUCH_FRONT_RIGHT 0x02
+#define INPUT_TOUCH_REAR_LEFT   0x04
+#define INPUT_TOUCH_REAR_RIGHT  0x08
+#define INPUT_IR_FRONT_LEFT     0x10
+#define INPUT_IR_FRONT_RIGHT    0x20
+#define INPUT_SW3               0x40    ///< PTDD3, active low
+#define INPUT_SW4               0x80    ///< PTDD2, active low
+#define INPUT_DEBOUNCE          4       ///< samples (input periods) to accept a change; fixed by input.c
+#define INPUT_QUEUE_SIZE        8       ///< must be a power of two
+//@}
+
 /// @name Line Following sensors
 /// We assume that PTBD0-3 are connected to line following sensors.
 //@{
@@ -112,8 +218,234 @@ typedef enum {
 #define lineFollowingRearRight  PTBD_PTBD2
 //@}
 
-/// System specific
-#define busClock        2   ///< system bus clock in MHz; one half of the CPU clock frequency (4 MHz)
+/// @name Maze
+/// Cells are numbered (y << 4) | x from the start corner; see 'maze.c'.
+/// The solver, the path optimiser and their RAM are built only with MAZE
+/// defined (e.g., -DMAZE).
+//@{
+#define MAZE_SIZE       16      ///< number of cells along each side
+#define MAZE_CELLS      256     ///< number of cells
+#define MAZE_START      0x00    ///< start cell in the south-west corner
+#define MAZE_UNREACHED  0xFF    ///< distance of a cell not reachable from the target
+#define MAZE_DIR_NORTH  0
+#define MAZE_DIR_EAST   1
+#define MAZE_DIR_SOUTH  2
+#define MAZE_DIR_WEST   3
+#define MAZE_NORTH      0x01    ///< wall on the north side of a cell
+#define MAZE_EAST       0x02    ///< wall on the east side of a cell
+#define MAZE_SOUTH      0x04    ///< wall on the south side of a cell
+#define MAZE_WEST       0x08    ///< wall on the west side of a cell
+#define MAZE_WALLS      0x0F    ///< all walls of a cell
+#define MAZE_VISITED    0x10    ///< the mouse has been in the cell
+#define MAZE_ON_PATH    0x20    ///< the cell is on a shortest path with the unseen walls open; see MazePlan()
+#define MAZE_WALL(dir)      ((byte)(1 << (dir)))
+#define MAZE_OPPOSITE(dir)  ((byte)(((dir) + 2) & 0x03))
+#define MAZE_X(cell)        ((byte)((cell) & 0x0F))
+#define MAZE_Y(cell)        ((byte)(((cell) >> 4) & 0x0F))
+#define MAZE_CELL(x, y)     ((byte)(((y) << 4) | (x)))
+//@}
+
+/// @name Path optimiser
+/// Segment types and motion limits of the fast run; see 'path.c'.
+//@{
+#define PATH_STRAIGHT       0   ///< orthogonal straight
+#define PATH_DIAGONAL       1   ///< diagonal straight
+#define PATH_TURN90         2   ///< smooth 90 degree turn between straights
+#define PATH_IN45           3   ///< 45 degree turn from a straight into a diagonal
+#define PATH_OUT45          4   ///< 45 degree turn from a diagonal into a straight
+#define PATH_IN135          5   ///< 135 degree turn from a straight into a diagonal
+#define PATH_OUT135         6   ///< 135 degree turn from a diagonal into a straight
+#define PATH_V90            7   ///< 90 degree turn between diagonals
+#define PATH_TYPE           0x0F    ///< mask for the segment type
+#define PATH_RIGHT          0x80    ///< the turn is to the right
+#define PATH_MAX_SEGMENTS   64  ///< capacity of pathSegments
+#define PATH_MAX_TURNS      64  ///< most turns on a route that can be compiled
+#define PATH_CELL_MM        180 ///< size of a maze cell in mm
+#define PATH_SPEED_UNIT     10  ///< unit of path speeds in mm/s
+#define PATH_ACCEL          2000    ///< acceleration and deceleration in mm/s^2
+#define PATH_MAX_SPEED      150 ///< speed limit on straights in PATH_SPEED_UNIT
+#define PATH_DIAGONAL_SPEED 120 ///< speed limit on diagonals in PATH_SPEED_UNIT
+#define PATH_TURN90_SPEED   50  ///< speed of smooth 90 degree turns in PATH_SPEED_UNIT
+#define PATH_TURN45_SPEED   60  ///< speed of 45 degree turns in PATH_SPEED_UNIT
+#define PATH_TURN135_SPEED  45  ///< speed of 135 degree turns in PATH_SPEED_UNIT
+#define PATH_V90_SPEED      45  ///< speed of 90 degree turns between diagonals in PATH_SPEED_UNIT
+//@}
+
+/// @name Motion command queue
+//@{
+#define MOTION_QUEUE_SIZE   8   ///< capacity of the motion queue plus one; a power of two
+#define MOTION_BACKOFF      50  ///< distance in mm to back off from an obstacle
+#define MOTION_ARC_RADIUS   90  ///< radius in mm of MOTION_ARC and of the veer commands; half a cell
+#define MOTION_ARC_INNER    3   ///< the inner wheel of an arc keeps at least 1/2^MOTION_ARC_INNER of the speed
+//@}
+
+/// @name Geometric calibration
+/// Guided runs of GeometryCalibrate() and the bounds of its results; see 'geometry.c'.
+//@{
+#define GEOMETRY_STRAIGHT   1000    ///< straight to drive in mm
+#define GEOMETRY_TURNS      5       ///< full turns to rotate in place
+#define GEOMETRY_SETTLE     25      ///< navigation periods to stand still after each run
+#define GEOMETRY_TICK_MIN   500     ///< least travel per tachometer pulse in um that is accepted
+#define GEOMETRY_TICK_MAX   2000    ///< most travel per tachometer pulse in um that is accepted
+#define GEOMETRY_TRACK_MIN  600     ///< least track width in 0.1 mm that is accepted
+#define GEOMETRY_TRACK_MAX  2500    ///< most track width in 0.1 mm that is accepted
+//@}
+
+/// @name Motor model identification
+/// Open-loop duty cycle steps of ModelIdentify(); see 'model.c'.
+//@{
+#define MODEL_STEPS     5       ///< number of steps
+#define MODEL_PERIODS   120     ///< control periods per step; several time constants
+#define MODEL_TAIL      32      ///< control periods at the end of a step averaged for its final speed
+#define MODEL_RISE      20      ///< least rise in pulses/s of a step that gives a time constant
+//@}
+
+/// @name Relay auto-tuning
+/// Relay experiment of TuneStart(); see 'tune.c'.
+//@{
+#define TUNE_RELAY      15      ///< duty cycle in percent that the relay switches above and below the bias
+#define TUNE_HYSTERESIS 8       ///< pulses/s beyond the target speed before the relay switches
+#define TUNE_SETTLE     60      ///< control periods at the bias before the relay starts
+#define TUNE_SKIP       2       ///< limit cycles left out as transient
+#define TUNE_CYCLES     4       ///< limit cycles measured
+#define TUNE_TIMEOUT    600     ///< control periods before the experiment gives up
+//@}
+
+/// @name Wheel monitor
+/// Bits of wheelState and thresholds of WheelCheck(); see 'wheel.c'.
+//@{
+#define WHEEL_STALL     0x01    ///< driven, but far slower than the motor model predicts
+#define WHEEL_SLIP      0x02    ///< far faster than predicted while the other wheel is not; no traction
+#define WHEEL_PUSHED    0x04    ///< turning without being driven, or both wheels faster than predicted
+#define WHEEL_MIN_SPEED 40      ///< pulses/s; slower wheels and predictions are not judged
+#define WHEEL_CONFIRM   3       ///< control periods that a condition must hold before it is flagged
+#define WHEEL_UNKNOWN   0xFFFF  ///< speed of a wheel that has not turned since it was switched on or off
+//@}
+
+/// @name Motor reversal
+/// A wheel is braked before its motor is driven the other way; see ControlMotor().
+//@{
+#define REVERSE_STILL       2   ///< control periods without a tachometer pulse that count as standing still
+#define REVERSE_BRAKE_MAX   20  ///< control periods of braking at the most before a reversal goes ahead
+//@}
+
+/// @name Combat
+/// States and drive of the combat mode; see 'combat.c'.
+//@{
+#define COMBAT_TRACK_RADIUS 45      ///< radius in mm of the arc towards an opponent seen by one sensor
+#define COMBAT_EVADE_RADIUS 90      ///< radius in mm of the arc away from a hit
+#define COMBAT_EVADE_TIME   30      ///< input periods of an evasion
+#define COMBAT_BURST        40      ///< control periods at pwMax in each burst of a push
+#define COMBAT_REST         10      ///< control periods between bursts
+#define COMBAT_EASE         15      ///< duty cycle in percent below pwMax between bursts, and off a slipping wheel
+#define COMBAT_STEER        20      ///< duty cycle in percent off the wheel on the side of a single touch bar
+//@}
+
+/// @name Reaction latency
+/// Histograms of LatencyReport(); see 'latency.c'.
+//@{
+#define LATENCY_BINS    11      ///< bins: under 1 ms, then octaves from 1 ms; the last from 512 ms up
+#define LATENCY_TIMEOUT 1000    ///< ms after an edge by which the motors must have reacted to it
+//@}
+
+/// @name Heading hold
+/// Outer loop of the speed controller on straight moves; see 'heading.c'.
+//@{
+#define HEADING_GAIN    8       ///< pulses/s of speed target per tachometer pulse of heading error
+#define HEADING_LIMIT   2       ///< the speed targets differ from the reference by at most its 1/2^HEADING_LIMIT
+//@}
+
+/// @name Wall sensing
+/// Distances from the analog IR sensors in mm; see 'wall.c'.
+//@{
+#define WALL_NONE       255     ///< distance when no wall is seen
+#define WALL_PRESENT    70      ///< a wall closer than this is followed
+#define WALL_DETECT     50      ///< a wall closer than this sets the INPUT_IR_* bit
+#define WALL_CENTRE     44      ///< distance to each wall in the middle of a corridor
+#define WALL_SHIFT      7       ///< 1 mm of error offsets the balance by nomSpeed >> WALL_SHIFT
+//@}
+
+/// @name Battery monitoring
+/// Voltages in mV; see 'battery.c'.
+//@{
+#define BATTERY_NOMINAL     7200    ///< voltage that pwLeft and pwRight are meant for
+#define BATTERY_LOW         6200    ///< batteryLow is set below this voltage
+#define BATTERY_HYSTERESIS  200     ///< batteryLow is cleared above BATTERY_LOW plus this
+#define BATTERY_ABSENT      2000    ///< lower readings mean that nothing is connected; no scaling
+#define BATTERY_FILTER      3       ///< the filter follows a step by 1/2^BATTERY_FILTER per sample
+#define BATTERY_COUNTS(mv)  ((word)((mv) * 256UL / ((dword)batteryDivider * adcReference)))  ///< ADC result of a voltage
+//@}
+
+/// @name Trace stream
+/// Record types of the trace stream; see 'trace.c'.
+//@{
+#define TRACE_START         0x10    ///< value: TPM2 modulus
+#define TRACE_PERIOD        0x20    ///< end of TaskControl(); value: pwLeft in the high byte, pwRight in the low byte
+#define TRACE_TACH_LEFT     0x30    ///< or'ed with TRACE_TACH_ADJUST(); value: TPM2C0V
+#define TRACE_TACH_RIGHT    0x31    ///< or'ed with TRACE_TACH_ADJUST(); value: TPM2C1V
+#define TRACE_TACH_ADJUST(adjust)   ((byte)(((adjust) + 1) << 2))  ///< tick adjustment (-1..1) of a capture
+#define TRACE_ADC           0x40    ///< or'ed with the channel; value: ADC result
+#define TRACE_INPUTS        0x50    ///< TaskInput(); value: PTAD in the high byte, PTDD in the low byte
+#define TRACE_LOST          0x60    ///< value: number of records dropped before this one
+#define TRACE_TICKS         0x70    ///< value: scheduler ticks completed since the last record
+#define TRACE_FIFO_SIZE     64      ///< bytes; must be a power of two
+#ifdef TRACE
+#define TRACE_RECORD(type, value)   TraceRecord(type, value)
+#define TRACE_TICK()                TraceTick()
+#else
+#define TRACE_RECORD(type, value)
+#define TRACE_TICK()
+#endif
+//@}
+
+/// @name Stack
+//@{
+#define STACK_PAINT     0xA5    ///< stack fill pattern; must equal STACK_PAINT in 'Start08.c'
+#define STACK_MARGIN    16      ///< unused bytes below which stackAlarm is raised
+//@}
+
+/// @name Fixed-point arithmetic
+//@{
+#define Q8_8_ONE        0x0100
+#define Q8_8_MAX        0x7FFF
+#define Q8_8_MIN        (-0x7FFF - 1)
+#define Q16_16_ONE      0x00010000L
+#define Q16_16_MAX      0x7FFFFFFFL
+#define Q16_16_MIN      (-0x7FFFFFFFL - 1)
+#define ANGLE_DEGREES(d)    ((Angle)((d) * 0x10000L / 360))   ///< for integer constants
+//@}
+
+/// @name Clock profiles
+/// Select a profile with CLOCK_PROFILE (e.g., -DCLOCK_PROFILE=CLOCK_2MHZ);
+/// the timer moduli, baud divisor and delay constants below follow from it.
+/// The tick ISR runs the tasks with interrupts masked, and at 2 MHz a tick
+/// is too short for TaskControl() with its 32-bit divisions, so 20 MHz is
+/// the default; see the Tick* phases of 's08/profile.c'.
+//@{
+#define CLOCK_2MHZ      1   ///< 4 MHz crystal with the FLL bypassed (FBE); 2 MHz bus
+#define CLOCK_20MHZ     2   ///< 4 MHz crystal multiplied by 10 by the FLL (FEE); 20 MHz bus
+#ifndef CLOCK_PROFILE
+#define CLOCK_PROFILE   CLOCK_20MHZ
+#endif
+#if CLOCK_PROFILE == CLOCK_2MHZ
+#define busClock        2           ///< system bus clock in MHz; one half of the ICG output clock frequency
+#define icgc1Value      0b01110100  ///< high range external crystal, FLL bypassed
+#define icgc2Value      0x00        ///< FLL multiplier and reference divider (unused)
+#define clockUsesFLL    0           ///< no need to wait for the FLL to lock
+#elif CLOCK_PROFILE == CLOCK_20MHZ
+#define busClock        20          ///< system bus clock in MHz; one half of the ICG output clock frequency
+#define icgc1Value      0b01111100  ///< high range external crystal, FLL engaged
+#define icgc2Value      0x30        ///< multiply by 10, divide by 1
+#define clockUsesFLL    1           ///< wait for the FLL to lock before going on
+#else
+#error "unknown CLOCK_PROFILE"
+#endif
+#define busClockHz      (busClock * 1000000UL)  ///< system bus clock in Hz
+#ifndef baudRate
+#define baudRate        9600UL      ///< baud rate of the SCI; tracing needs more, e.g., -DbaudRate=115200UL
+#endif
+#define delayLoopCycles 10UL        ///< bus cycles of one inner loop of Delay(); check against the listing
+//@}
 
 /// @name Motor speed control
 //@{
@@ -122,11 +454,109 @@ typedef enum {
 #define HIGH_WORD       0xFFFF
 #define LOW_WORD        0x0000
 #define pwmPeriod       10  ///< period of PWM signal in ms
-#define controlPeriod   50  ///< period of motor speed control in ms
+#define tachPeriodMax   50  ///< longest tachometer period in ms that diffLeft and diffRight resolve
 //#define defaultSpeed    25  ///< default speed in terms of percentage duty cycle (e.g., 100% for full speed)
 #define defaultSpeed    33  ///< default speed in terms of percentage duty cycle (e.g., 100% for full speed)
 //@}
 
+/// @name Scheduler
+/// The TPM2 overflow is the tick of the scheduler; every task runs once in
+/// its period, which is a multiple of tickPeriod. See 'sched.c'.
+//@{
+#define tickPeriod      1   ///< period of the scheduler tick in ms
+#define sensePeriod     1   ///< period of wall sensing in ms
+#define inputPeriod     10  ///< period of input sampling in ms; INPUT_DEBOUNCE of them debounce an input
+#define controlPeriod   5   ///< period of motor speed control in ms
+#define navigatePeriod  20  ///< period of motion commands, CPU load and stack checks in ms
+#define SCHED_TICKS(ms) ((ms) / tickPeriod)     ///< ticks in 'ms' milliseconds
+//@}
+
+/// @name Derived timing constants
+/// Computed and range-checked at compile time from the clock profile.
+//@{
+/// TPM prescaler (0..7; 8 if out of range) for a period of 'counts' bus cycles
+#define TPM_PRESCALER(counts)   ((counts) <= 0x10000UL ? 0 : (counts) <= 0x20000UL ? 1 \
+                                : (counts) <= 0x40000UL ? 2 : (counts) <= 0x80000UL ? 3 \
+                                : (counts) <= 0x100000UL ? 4 : (counts) <= 0x200000UL ? 5 \
+                                : (counts) <= 0x400000UL ? 6 : (counts) <= 0x800000UL ? 7 : 8)
+#define pwmCycles       (pwmPeriod * (busClockHz / 1000UL))     ///< bus cycles per PWM period
+#define tickCycles      (tickPeriod * (busClockHz / 1000UL))    ///< bus cycles per scheduler tick
+#define tachCycles      (tachPeriodMax * (busClockHz / 1000UL)) ///< bus cycles per tachPeriodMax
+#define TPM1_PS         TPM_PRESCALER(pwmCycles)                ///< TPM1 prescaler (PS bits)
+#define TPM1_MOD        ((pwmCycles >> TPM1_PS) - 1UL)          ///< TPM1 modulus for the PWM period
+#define TPM2_PS         TPM_PRESCALER(tachCycles)               ///< TPM2 prescaler (PS bits)
+#define TPM2_MOD        ((tickCycles >> TPM2_PS) - 1UL)         ///< TPM2 modulus for the scheduler tick
+#define TPM2_COUNTS(us) (((us) * 1UL * busClock) >> TPM2_PS)     ///< TPM2 counts in 'us' microseconds
+#define TPM2_HZ         TPM2_COUNTS(1000000UL)                  ///< TPM2 counts per second
+#define SCI_BD          ((busClockHz + 8UL * baudRate) / (16UL * baudRate))    ///< SCI baud rate divisor
+#define SCI_BAUD_ERROR  ((SCI_BD * 16UL * baudRate > busClockHz) \
+                        ? SCI_BD * 16UL * baudRate - busClockHz : busClockHz - SCI_BD * 16UL * baudRate)
+#define delayLoopsPerMs (busClockHz / 1000UL / delayLoopCycles) ///< inner loops of Delay() per ms
+
+#if TPM1_PS > 7
+#error "pwmPeriod is too long for TPM1 at this bus clock"
+#endif
+#if TPM1_MOD < 100
+#error "pwmPeriod is too short for 1% duty cycle steps at this bus clock"
+#endif
+#if TPM2_PS > 7
+#error "tachPeriodMax is too long for TPM2 at this bus clock"
+#endif
+#if TPM2_MOD < 100 || tickCycles > tachCycles
+#error "tickPeriod is out of range of TPM2 at this bus clock"
+#endif
+#if sensePeriod % tickPeriod || inputPeriod % tickPeriod || controlPeriod % tickPeriod || navigatePeriod % tickPeriod
+#error "task periods must be multiples of tickPeriod"
+#endif
+#if SCHED_TICKS(navigatePeriod) > 255 || SCHED_TICKS(inputPeriod) > 255 || SCHED_TICKS(controlPeriod) > 255
+#error "task periods must be at most 255 ticks"
+#endif
+#if SCI_BD < 1 || SCI_BD > 8191
+#error "baudRate is out of range of the SCI at this bus clock"
+#endif
+#if SCI_BAUD_ERROR * 100UL > 3UL * busClockHz
+#error "baudRate is more than 3% off at this bus clock"
+#endif
+#if delayLoopsPerMs < 1 || delayLoopsPerMs > 32767
+#error "delayLoopsPerMs is out of range of Delay()"
+#endif
+//@}
+
+/// @name Speed controller gains
+/// Default values loaded into the controller variables at start-up;
+/// 'host/sweep' prints a tuned set of these definitions.
+//@{
+#define defaultScaleFactor  200     ///< divisor applied to tachometer period errors
+#define defaultNomPeriod    4096    ///< target tachometer period in us; 0 disables speed regulation
+#define defaultPwMax        90      ///< maximum for PWM duty cycle
+#define defaultPwMin        10      ///< minimum for PWM duty cycle
+#define defaultSpeedStep    2       ///< maximum change of PWM duty cycle per control period
+#define defaultSpeedGain    0       ///< proportional gain in 1/256 % per pulse/s; Debug 'U' tunes it
+#define defaultNomSpeed     ((int)TPM2_COUNTS(defaultNomPeriod))    ///< defaultNomPeriod in TPM2 counts
+#if TPM2_COUNTS(defaultNomPeriod) > 32767
+#error "defaultNomPeriod is out of range of nomSpeed at this bus clock"
+#endif
+//@}
+
+/// @name Motor model
+/// Default feed-forward of both motors; 'host/ident' prints identified
+/// values, and Debug 'I' identifies the motors of the mouse itself. All
+/// zero disables the feed-forward.
+//@{
+#define defaultModelFriction    6       ///< duty cycle in percent that overcomes static friction
+#define defaultModelVelocity    9228    ///< 1/65536 % duty cycle per tachometer pulse/s
+#define defaultModelAccel       854     ///< 1/65536 % duty cycle per tachometer pulse/s^2
+//@}
+
+/// @name Geometry
+/// Default travel per tachometer pulse and track width; Debug 'Y'
+/// calibrates them and prints the values for the mouse.
+//@{
+#define defaultWheelTickLeft    1000    ///< travel of the left wheel per tachometer pulse in um
+#define defaultWheelTickRight   1000    ///< travel of the right wheel per tachometer pulse in um
+#define defaultTrackWidth       1273    ///< effective track width in 0.1 mm; a 90 degree turn is 200 pulses
+//@}
+
 
 //------------------------------------------------------------------------------
 //  Variables
@@ -135,17 +565,81 @@ EXTERN MouseMode mouseMode;     ///< operation mode of mouse
 EXTERN MouseStatus mouseStatus;	///< status of mouse
 EXTERN MotorStatus leftMotor;   ///< status of left motor
 EXTERN MotorStatus rightMotor;  ///< status of right motor
+EXTERN int arcRadius;           ///< radius in mm of MOUSE_STATUS_ARC; positive turns left
 
 // Motor speed control
 EXTERN word diffLeft;            ///< difference between two consecutive counter values for left motor
 EXTERN word diffRight;           ///< difference between two consecutive counter values for right motor
-EXTERN int travelDistance;      ///< distance to travel; one unit is approximately 0.5 mm
+EXTERN int travelDistance;      ///< tachometer pulses of both wheels left to travel; see GeometryMove()
 EXTERN int scaleFactor;         ///< scale factor used in motor speed control
-EXTERN int nomSpeed;
-EXTERN word pwLeft;
-EXTERN word pwRight;
-EXTERN word pwMax;
-EXTERN word pwMin;
+EXTERN int nomSpeed;            ///< target tachometer period in TPM2 counts; 0 disables speed regulation
+EXTERN word pwLeft;             ///< PWM duty cycle for left motor in percent
+EXTERN word pwRight;            ///< PWM duty cycle for right motor in percent
+EXTERN word pwMax;              ///< maximum for PWM duty cycle
+EXTERN word pwMin;              ///< minimum for PWM duty cycle
+EXTERN word speedStep;          ///< maximum change of PWM duty cycle per control period
+EXTERN int trimLeft;            ///< feedback part of pwLeft; the motor model gives the rest
+EXTERN int trimRight;           ///< feedback part of pwRight; the motor model gives the rest
+EXTERN word speedGain;          ///< proportional gain of the speed feedback in 1/256 % per pulse/s
+EXTERN volatile byte tuning;    ///< TuneStart() is driving the motors
+EXTERN word speedReference;     ///< speed in pulses/s that the feed-forward drives at; 0 while a motor stands
+EXTERN volatile word tachCount[2];  ///< tachometer pulses since start-up, indexed by Motor; wraps around
+
+// Motor model
+EXTERN MotorModel motorModel[2];    ///< feed-forward of each motor, indexed by Motor
+EXTERN volatile byte modelIdentifying;  ///< ModelIdentify() is driving the motors
+
+// Geometry
+EXTERN word wheelTick[2];       ///< travel of each wheel per tachometer pulse in um, indexed by Motor
+EXTERN word trackWidth;         ///< effective track width in 0.1 mm
+
+// Combat
+EXTERN volatile CombatState combatState;   ///< state of the combat mode
+
+// Wheel monitor
+EXTERN volatile word wheelSpeed[2]; ///< measured speed of each wheel in pulses/s, indexed by Motor
+EXTERN volatile byte wheelState[2]; ///< WHEEL_* conditions of each wheel, indexed by Motor
+
+// Digital inputs
+EXTERN volatile byte inputLevels;   ///< debounced levels of the INPUT_* inputs
+EXTERN volatile word inputTime;     ///< input samples taken, i.e., input periods since InputInit()
+
+// CPU load
+EXTERN word loadIdleMax;            ///< idle loop passes in a navigation period with nothing else running
+EXTERN volatile byte loadPercent;   ///< CPU load over the last navigation period in percent
+EXTERN volatile word loadIsrBusy[LOAD_SOURCES];    ///< TPM2 counts spent in each ISR over the last navigation period
+
+// Scheduler
+EXTERN volatile word schedTicks;    ///< scheduler ticks since SchedInit(); extends TPM2CNT for the tachometers
+EXTERN volatile word schedWorst[SCHED_TASKS];      ///< longest run of each task in TPM2 counts
+EXTERN volatile byte schedOverruns[SCHED_TASKS];   ///< runs of each task that ended after the next tick was due
+EXTERN volatile word schedSlip;     ///< schedTicks of the last tick whose tasks ran into the next; ticks may have been lost in it
+
+// Wall sensing
+EXTERN volatile byte wallSensing;   ///< the IR sensors are read through the ADC and centre the mouse
+EXTERN volatile byte wallDistance[2];   ///< distance to the wall in mm, indexed by Motor
+
+// Battery
+EXTERN volatile word batteryLevel;  ///< filtered ADC result of batteryChannel; 8.8 fixed point
+EXTERN volatile word batteryScale;  ///< duty cycle factor BATTERY_NOMINAL / battery voltage; 8.8 fixed point
+EXTERN volatile byte batteryLow;    ///< the battery voltage is below BATTERY_LOW
+
+// Stack
+EXTERN volatile byte stackAlarm;    ///< set once the stack has come within STACK_MARGIN bytes of its end
+
+// Maze
+#ifdef MAZE
+EXTERN byte mazeMap[MAZE_CELLS];    ///< walls, MAZE_VISITED and MAZE_ON_PATH of each cell
+EXTERN byte mazeDist[MAZE_CELLS];   ///< distance of each cell to the current target in cells
+EXTERN byte mazeCell;           ///< cell the mouse is in
+EXTERN byte mazeHeading;        ///< direction the mouse is facing (MAZE_DIR_*)
+EXTERN PathSegment pathSegments[PATH_MAX_SEGMENTS];    ///< compiled route of the fast run
+EXTERN byte pathCount;          ///< number of segments in pathSegments
+#ifdef MAZE_STATS
+EXTERN dword mazeCellUpdates;   ///< cells expanded by MazeFlood() since reset
+EXTERN word mazeQueuePeak;      ///< largest number of cells queued by MazeFlood()
+#endif
+#endif  // MAZE
 
 
 //------------------------------------------------------------------------------
@@ -154,22 +648,197 @@ EXTERN word pwMin;
 /// @name Functions for mouse
 //@{
 void AvoidObstacle(void);
+void AvoidObstacleStep(void);
+void Combat(void);
 void ControlMouse(MouseAction action);
+void ControlArc(int radius);
 void LineFollowing(void);
+void LineFollowingStep(void);
 void Debug(void);
+#ifdef MAZE
+void MazeSearch(void);
+#endif
 void Test(void);
+void MouseSetup(void);
+//@}
+
+/// @name Functions for the motion command queue
+//@{
+byte MotionPush(MotionType type, int amount);
+byte MotionIdle(void);
+void MotionClear(void);
+void MotionService(byte tick);
+//@}
+
+/// @name Functions for debounced inputs
+//@{
+void InputInit(void);
+byte InputSample(void);
+byte InputGetEvent(InputEvent *event);
+//@}
+
+/// @name Functions for the scheduler
+//@{
+void SchedInit(void);
+void SchedTick(void);
+void SchedReport(void);
+void TaskSense(void);
+void TaskInput(void);
+void TaskControl(void);
+void TaskNavigate(void);
+//@}
+
+/// @name Functions for CPU load measurement
+//@{
+void LoadIdle(void);
+void LoadCalibrate(void);
+word LoadEnter(word event);
+void LoadExit(LoadSource source, word start);
+void LoadPeriod(void);
+void LoadReport(void);
+//@}
+
+/// @name Functions for wall sensing
+//@{
+void WallInit(byte enable);
+void WallSample(void);
+int WallCorrection(void);
+void WallReport(void);
+//@}
+
+/// @name Functions for battery monitoring
+//@{
+void BatteryInit(void);
+void BatterySample(void);
+word BatteryDuty(word pw);
+word BatteryMillivolts(void);
+void BatteryReport(void);
+//@}
+
+/// @name Functions for motor models
+//@{
+void ModelInit(void);
+word ModelSpeed(word period);
+int ModelDuty(Motor motor, word speed, long accel);
+word ModelRamp(word from, word to);
+void ModelIdentify(void);
+void ModelIdentifyStep(void);
+void ModelReport(void);
+//@}
+
+/// @name Functions for the relay auto-tuning
+//@{
+void TuneStart(void);
+void TuneStep(void);
+void TuneReport(void);
+//@}
+
+/// @name Functions for the geometry
+//@{
+void GeometryInit(void);
+int GeometryMove(int mm);
+int GeometryTurn(int degrees);
+int GeometryArc(int degrees, int radius);
+void GeometryCalibrate(void);
+void GeometryReport(void);
+//@}
+
+/// @name Functions for the combat mode
+//@{
+void CombatStart(void);
+void CombatStep(void);
+void CombatDrive(void);
+void CombatReport(void);
+//@}
+
+/// @name Functions for the reaction latency
+//@{
+void LatencyInit(void);
+void LatencyEdge(word ticks);
+void LatencyCommand(void);
+void LatencyWrite(byte command);
+word LatencyReactions(MouseMode mode);
+void LatencyReportMode(MouseMode mode, char *name);
+void LatencyReport(void);
+//@}
+
+/// @name Functions for the wheel monitor
+//@{
+void WheelInit(void);
+void WheelCheck(void);
+void WheelReport(void);
+//@}
+
+/// @name Functions for the heading hold
+//@{
+void HeadingReset(void);
+int HeadingOffset(word speed);
+//@}
+
+/// @name Functions for the trace stream
+//@{
+void TraceInit(void);
+void TraceRecord(byte type, word value);
+void TraceTick(void);
+//@}
+
+/// @name Functions for stack probes
+//@{
+word StackSize(void);
+word StackUsed(void);
+void StackCheck(void);
+void StackReport(void);
 //@}
 
 /// @name Functions for motors
 //@{
+void ControlInit(void);
 void ControlMotor(Motor motor, MotorAction action);
+void ControlReversal(void);
 void ControlSpeed(void);
 //@}
 
 /// @name Interrupt service routines (ISRs)
 //@{
 interrupt VectorNumber_Vkeyboard1 void intSW3_4(void);
-interrupt VectorNumber_Vtpm1ovf void intTPM1OVF(void);
+interrupt VectorNumber_Vtpm2ovf void intTPM2OVF(void);
+interrupt VectorNumber_Vtpm2ch0 void intTPM2CH0(void);
+interrupt VectorNumber_Vtpm2ch1 void intTPM2CH1(void);
+interrupt VectorNumber_Vsci2tx void intSCI2TX(void);
+//@}
+
+/// @name Functions for maze solving
+//@{
+#ifdef MAZE
+void MazeInit(void);
+void MazeSetWalls(byte cell, byte walls);
+byte MazeOnBoard(byte cell, byte dir);
+byte MazeIsGoal(byte cell);
+void MazeFlood(byte toStart);
+byte MazeNextDirection(void);
+void MazeMove(byte dir);
+byte MazeStep(byte walls, byte toStart);
+byte MazePlan(void);
+byte MazeExploreStep(byte walls);
+byte PathCompile(byte diagonals);
+word PathSegmentLength(byte index);
+#endif  // MAZE
+//@}
+
+/// @name Functions for fixed-point arithmetic
+//@{
+Q8_8 FixAdd8(Q8_8 a, Q8_8 b);
+Q8_8 FixMul8(Q8_8 a, Q8_8 b);
+Q8_8 FixDiv8(Q8_8 a, Q8_8 b);
+Q16_16 FixAdd16(Q16_16 a, Q16_16 b);
+Q16_16 FixMul16(Q16_16 a, Q16_16 b);
+Q16_16 FixDiv16(Q16_16 a, Q16_16 b);
+word FixSqrt(dword x);
+Q8_8 FixSqrt8(Q8_8 x);
+Q16_16 FixSqrt16(Q16_16 x);
+Q16_16 FixSin(Angle a);
+Q16_16 FixCos(Angle a);
+Angle FixAtan2(long y, long x);
 //@}
 
 /// @name Funcion for serial communicaiton through SCI
@@ -182,6 +851,8 @@ void SCISendStr(char *str);
 void SCIDisplayPrompt(void);
 void SCIDisplayBitString(char ch);
 void SCISendNewLine(void);
+void SCISendDec(word value);
+int SCIGetDec(void);
 //@}
 
 
@@ -189,8 +860,9 @@ void SCISendNewLine(void);
 //@{
 byte BitSet(byte Bit_position, byte Var_old);
 byte BitClear(byte Bit_position, byte Var_old);
-void Delay(int);
+void Delay(int ms);
 byte ADCRead(byte ch);
+byte ADCConvert(byte ch);
 //@}
 
 
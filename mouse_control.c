@@ -31,6 +31,8 @@ void ControlMouse(MouseAction action)
         }
         if (mouseStatus != MOUSE_STATUS_FORWARD) {
             mouseStatus = MOUSE_STATUS_FORWARD;
+            HeadingReset();     // a new straight
+            LatencyCommand();
         }
         break;
     case MOUSE_ACTION_REVERSE:
@@ -42,6 +44,8 @@ void ControlMouse(MouseAction action)
         }
         if (mouseStatus != MOUSE_STATUS_REVERSE) {
             mouseStatus = MOUSE_STATUS_REVERSE;
+            HeadingReset();     // a new straight
+            LatencyCommand();
         }
         break;
     case MOUSE_ACTION_BRAKE:
@@ -100,6 +104,38 @@ void ControlMouse(MouseAction action)
             mouseStatus = MOUSE_STATUS_TURNAROUND;
         }
         break;        
+    case MOUSE_ACTION_ROTATELEFT:
+        if (leftMotor != MOTOR_STATUS_REVERSE) {
+            ControlMotor(MOTOR_LEFT, MOTOR_ACTION_REVERSE);
+        }
+        if (rightMotor != MOTOR_STATUS_FORWARD) {
+            ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_FORWARD);
+        }
+        if (mouseStatus != MOUSE_STATUS_ROTATELEFT) {
+            mouseStatus = MOUSE_STATUS_ROTATELEFT;
+        }
+        break;        
 
     } // end of switch()
 }
+
+
+// move along an arc of 'radius' mm, positive to the left, at nomSpeed; both
+// wheels stay driven, and ControlSpeed() sets their speeds apart for the
+// curvature. Radii shorter than MOTION_ARC_INNER allows are taken as that.
+void ControlArc(int radius)
+{
+    if (leftMotor != MOTOR_STATUS_FORWARD) {
+        ControlMotor(MOTOR_LEFT, MOTOR_ACTION_FORWARD);
+    }
+    if (rightMotor != MOTOR_STATUS_FORWARD) {
+        ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_FORWARD);
+    }
+    if (mouseStatus != MOUSE_STATUS_ARC || arcRadius != radius) {
+        LatencyCommand();   // new speeds for the wheels
+    }
+    arcRadius = radius;
+    if (mouseStatus != MOUSE_STATUS_ARC) {
+        mouseStatus = MOUSE_STATUS_ARC;
+    }
+}
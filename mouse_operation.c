@@ -19,135 +19,292 @@
 #include "mouse.h"	// for the declaration of types, constants, variables and functions
 
 
-void AvoidObstacle()
+// queue the manoeuvre to get away from an obstacle: back off, then rotate
+// by 'degrees' (positive is anticlockwise)
+static void Escape(int degrees)
 {
-    mouseMode = MOUSE_MODE_OBSTACLE_AVOIDING;
+    MotionPush(MOTION_STOP, 1);
+    MotionPush(MOTION_MOVE, -MOTION_BACKOFF);
+    MotionPush(MOTION_TURN, degrees);
+}
 
-    for (;;) {
-        // first move forward
-        ControlMouse(MOUSE_ACTION_FORWARD);
 
-        // first, check the status of touch bars
-        if (!touchBarFrontLeft && !touchBarFrontRight) {
-            // neither is touched (i.e., both the values are zero)
+// stop the mouse and drop its manoeuvres while the battery is low; returns 1 if
+// it did
+static byte BatteryStop(void)
+{
+    if (!batteryLow) {
+        return 0;
+    }
+    MotionClear();      // stops the mouse as well
+    return 1;
+}
+
+
+// sensor thresholds set by the calibration in LineFollowing()
+static byte flTH, frTH, rlTH, rrTH;
+static byte lineLast;   // sensors over the line in the last pass, one bit each
+
+
+// one pass of the obstacle avoiding loop
+void AvoidObstacleStep()
+{
+    byte touch, infrared;
+
+    if (BatteryStop()) {
+        return;
+    }
+    if (!MotionIdle()) {
+        return;     // an escape manoeuvre is being executed by the ISRs
+    }
+
+    // debounced levels of the front sensors
+    touch = inputLevels & (INPUT_TOUCH_FRONT_LEFT | INPUT_TOUCH_FRONT_RIGHT);
+    infrared = inputLevels & (INPUT_IR_FRONT_LEFT | INPUT_IR_FRONT_RIGHT);
+
+    // a stalled wheel means an obstacle that the touch bars have missed
+    if ((wheelState[MOTOR_LEFT] | wheelState[MOTOR_RIGHT]) & WHEEL_STALL) {
+        Escape(-180);
+        return;
+    }
 
-            // then check the status of IF sensors
-            if (!infraredFrontLeft && !infraredFrontRight) {
-                // neither is touched (i.e., both the values are zero)
-                // then, back to the loop
-            }
-            else if (infraredFrontLeft && !infraredFrontRight) {
-                // left sensor detects; avoid left obstacle
-
-            }
-            else if (!infraredFrontLeft && infraredFrontRight) {
-                // right sensor detects; avoid right obstacle
-
-            }
-            else {
-                // both sensors detect; avoid front obstacle
-                ControlMouse(MOUSE_ACTION_STOP);
-                ControlMouse(MOUSE_ACTION_REVERSE);
-                ControlMouse(MOUSE_ACTION_TURNAROUND);	// 180 dgree turn
-            }
+    // first, check the status of touch bars
+    if (touch == 0) {
+        // neither is touched (i.e., both the values are zero)
+
+        // then check the status of IF sensors
+        if (infrared == 0) {
+            // neither is touched (i.e., both the values are zero)
+            // then move forward, and back to the loop
+            ControlMouse(MOUSE_ACTION_FORWARD);
         }
-        else if (touchBarFrontLeft && !touchBarFrontRight) {
-            // left bar is touched; avoid left obstacle
-            ControlMouse(MOUSE_ACTION_STOP);
-            ControlMouse(MOUSE_ACTION_REVERSE);
-            ControlMouse(MOUSE_ACTION_TURNRIGHT);
+        else if (infrared == INPUT_IR_FRONT_LEFT) {
+            // left sensor detects; veer away from the obstacle at speed
+            ControlArc(-MOTION_ARC_RADIUS);
         }
-        else if (!touchBarFrontLeft && touchBarFrontRight) {
-            // right bar is touched; avoid right obstacle
-            ControlMouse(MOUSE_ACTION_STOP);
-            ControlMouse(MOUSE_ACTION_REVERSE);
-            ControlMouse(MOUSE_ACTION_TURNLEFT);
+        else if (infrared == INPUT_IR_FRONT_RIGHT) {
+            // right sensor detects; veer away from the obstacle at speed
+            ControlArc(MOTION_ARC_RADIUS);
         }
         else {
-            // both bars are touched; avoid front obstacle
-            ControlMouse(MOUSE_ACTION_STOP);
-            ControlMouse(MOUSE_ACTION_REVERSE);
-            ControlMouse(MOUSE_ACTION_TURNAROUND);	// 180 dgree turn
+            // both sensors detect; avoid front obstacle
+            Escape(-180);	// 180 dgree turn
         }
-    } // end of for() loop
+    }
+    else if (touch == INPUT_TOUCH_FRONT_LEFT) {
+        // left bar is touched; avoid left obstacle
+        Escape(-90);
+    }
+    else if (touch == INPUT_TOUCH_FRONT_RIGHT) {
+        // right bar is touched; avoid right obstacle
+        Escape(90);
+    }
+    else {
+        // both bars are touched; avoid front obstacle
+        Escape(-180);	// 180 dgree turn
+    }
 }
 
 
-void LineFollowing ()
+void AvoidObstacle()
+{
+    mouseMode = MOUSE_MODE_OBSTACLE_AVOIDING;
+
+    for (;;) {
+        AvoidObstacleStep();
+        LoadIdle();
+    }
+}
+
+
+// one pass of the line following loop
+void LineFollowingStep()
 {
     byte fl, fr, rl, rr;
+    byte tmp;
+
+    if (BatteryStop()) {
+        return;
+    }
+
+    // first move forward
+    ControlMouse(MOUSE_ACTION_FORWARD);
+
+    // update the status of each sensor
+    tmp = ADCRead(0x01);
+    fl = tmp < flTH ? 0 : 1;
+    tmp = ADCRead(0x00);
+    fr = tmp < frTH ? 0 : 1;
+    tmp = ADCRead(0x03);
+    rl = tmp < rlTH ? 0 : 1;
+    tmp = ADCRead(0x02);
+    rr = tmp < rrTH ? 0 : 1;
+
+    // a crossing of a threshold is an edge for the reaction latency
+    tmp = (byte)(fl | (fr << 1) | (rl << 2) | (rr << 3));
+    if (tmp != lineLast) {
+        lineLast = tmp;
+        DisableInterrupts;
+        LatencyEdge(schedTicks);
+        EnableInterrupts;
+    }
+
+    if (fl == 1 && fr == 1 && rl == 1 && rr == 1) {
+        // the mouse is on track (i.e., following the line correctly)
+        ControlMouse(MOUSE_ACTION_FORWARD);
+        Delay(250);
+    }
+    /* the rest of logical branches to be completed by each of you
+    else if () {
+    }
+    */
+}
+
+
+void LineFollowing ()
+{
     byte flMax, frMax, rlMax, rrMax;
     byte flMin, frMin, rlMin, rrMin;
-    byte flTH, frTH, rlTH, rrTH;
-    byte tmp;
 
-    mouseMode = MOUSE_MODE_OBSTACLE_AVOIDING;
+    mouseMode = MOUSE_MODE_LINE_FOLLOWING;
     ControlMouse(MOUSE_ACTION_STOP);
 
     // first, record values from black surface
     // once you place your mouse on black surface, hit the front left touch bar
     while (touchBarFrontLeft == 0)
     {
+        LoadIdle();
     }
     flMax = ADCRead(0x01);
     frMax = ADCRead(0x00);
     rlMax = ADCRead(0x03);
     rrMax = ADCRead(0x02);
     ControlMouse(MOUSE_ACTION_FORWARD); // to indicate it's done
-    Delay(500);
+    Delay(250);
     ControlMouse(MOUSE_ACTION_STOP);
 
     // then you place your mouse on white surface, hit the front left touch bar
     while (touchBarFrontLeft == 0)
     {
+        LoadIdle();
     }
     flMin = ADCRead(0x01);
     frMin = ADCRead(0x00);
     rlMin = ADCRead(0x03);
     rrMin = ADCRead(0x02);
     ControlMouse(MOUSE_ACTION_FORWARD); // to indicate it's done
-    Delay(500);
+    Delay(250);
     ControlMouse(MOUSE_ACTION_STOP);
     
     // finally, set optimal thresholds for sensors
-    flTH = (byte)(flMax/2.0 + flMin/2.0);
-    frTH = (byte)(frMax/2.0 + frMin/2.0);
-    rlTH = (byte)(rlMax/2.0 + rlMin/2.0);
-    rrTH = (byte)(rrMax/2.0 + rrMin/2.0);
+    flTH = (byte)(((word)flMax + flMin) >> 1);
+    frTH = (byte)(((word)frMax + frMin) >> 1);
+    rlTH = (byte)(((word)rlMax + rlMin) >> 1);
+    rrTH = (byte)(((word)rrMax + rrMin) >> 1);
 
     for (;;) {
-        // first move forward
-        ControlMouse(MOUSE_ACTION_FORWARD);
+        LineFollowingStep();
+        LoadIdle();
+    }
+}
 
-        // update the status of each sensor
-        tmp = ADCRead(0x01);
-        fl = tmp < flTH ? 0 : 1;
-        tmp = ADCRead(0x00);
-        fr = tmp < frTH ? 0 : 1;
-        tmp = ADCRead(0x03);
-        rl = tmp < rlTH ? 0 : 1;
-        tmp = ADCRead(0x02);
-        rr = tmp < rrTH ? 0 : 1;
-
-        if (fl == 1 && fr == 1 && rl == 1 && rr == 1) {
-            // the mouse is on track (i.e., following the line correctly)
-            ControlMouse(MOUSE_ACTION_FORWARD);
-            Delay(500);
-        }
-        /* the rest of logical branches to be completed by each of you
-        else if () {
+
+// combat mode: the state machine runs in TaskInput() and TaskControl(); the
+// main loop reports the latency of every new reaction
+void Combat()
+{
+    word reported = 0;
+
+    mouseMode = MOUSE_MODE_COMBAT;
+    CombatStart();
+    for (;;) {
+        if (LatencyReactions(MOUSE_MODE_COMBAT) != reported) {
+            reported = LatencyReactions(MOUSE_MODE_COMBAT);
+            CombatReport();
         }
-        */
-    } // end of for() loop
+        LoadIdle();
+    }
 }
 
 
-void Combat()
+#ifdef MAZE
+// walls around mazeCell as MAZE_* bits: the sides from the wall distances,
+// and the front if both digital infrared sensors see something ahead
+static byte MazeWalls(void)
 {
-    // fill your code here for the combat mode    
+    byte walls = 0;
+
+    if (wallDistance[MOTOR_LEFT] < WALL_PRESENT) {
+        walls |= MAZE_WALL((mazeHeading + 3) & 0x03);
+    }
+    if (wallDistance[MOTOR_RIGHT] < WALL_PRESENT) {
+        walls |= MAZE_WALL((mazeHeading + 1) & 0x03);
+    }
+    if (infraredFrontLeft && infraredFrontRight) {
+        walls |= MAZE_WALL(mazeHeading);
+    }
+    return walls;
 }
 
 
+// maze mode: the search run to the centre by flood fill, then the way back
+// planned by MazeExploreStep(), which explores the cells that may still make
+// the shortest path shorter. The mouse reads the walls in each cell while it
+// stands still, and the turn and the move to the next cell go through the
+// motion queue. Returns at the start, or when the target cannot be reached.
+void MazeSearch()
+{
+    byte heading, walls, toStart = 0;
+
+    mouseMode = MOUSE_MODE_MAZE;
+    MotionClear();
+    WallInit(1);
+    MazeInit();
+    for (;;) {
+        while (!MotionIdle()) {
+            LoadIdle(); // the ISRs drive the move
+        }
+        if (BatteryStop()) {
+            break;
+        }
+        walls = MazeWalls();
+        if (!toStart && MazeIsGoal(mazeCell)) {
+            toStart = 1;    // the way back explores
+        }
+        if (toStart && mazeCell == MAZE_START) {
+            MazeSetWalls(mazeCell, walls);
+            break;
+        }
+
+        heading = mazeHeading;
+        if (toStart) {
+            MazeExploreStep(walls);
+        }
+        else {
+            MazeStep(walls, 0);
+        }
+        if (mazeDist[mazeCell] == MAZE_UNREACHED) {
+            break;          // walled in, as far as the sensors tell
+        }
+        switch ((byte)(mazeHeading - heading) & 0x03) {
+        case 1:
+            MotionPush(MOTION_TURN, -90);
+            break;
+        case 2:
+            MotionPush(MOTION_TURN, 180);
+            break;
+        case 3:
+            MotionPush(MOTION_TURN, 90);
+            break;
+        }
+        MotionPush(MOTION_MOVE, PATH_CELL_MM);
+    }
+    MotionClear();
+    WallInit(0);
+}
+#endif
+
+
 // debug mode with simple command-line interface
 void Debug()
 {
@@ -164,12 +321,25 @@ void Debug()
     SCISendStr("S\tStop\r\n");
     SCISendStr("A\troate Anticlockwise\r\n");
     SCISendStr("C\trotate Clockwise\r\n");
-    SCISendStr("V\tVeer left Clockwise\r\n");
-    SCISendStr("B\tVeer right Clockwise\r\n");
+    SCISendStr("V\tVeer left along an arc\r\n");
+    SCISendStr("B\tVeer right along an arc\r\n");
     SCISendStr("+\tIncrement speed by 256 units\r\n");
     SCISendStr("-\tDecrement speed by 256 units\r\n");
     SCISendStr("D\tDisplay ADC value 7 through 0\r\n");
     SCISendStr("P\tDisplay PTA as binary number\r\n");
+    SCISendStr("L\tDisplay CPU load\r\n");
+    SCISendStr("M\tDisplay stack use\r\n");
+    SCISendStr("T\tDisplay task run times and overruns\r\n");
+    SCISendStr("W\tSense walls and display their distances\r\n");
+    SCISendStr("G\tDisplay battery voltage\r\n");
+    SCISendStr("I\tIdentify the motor models from step responses\r\n");
+    SCISendStr("K\tDisplay wheel speeds, slip and stall\r\n");
+    SCISendStr("U\tTune the speed controller by relay feedback (on blocks)\r\n");
+    SCISendStr("Y\tCalibrate the wheel travel and the track width\r\n");
+    SCISendStr("H\tDisplay reaction latency histograms\r\n");
+#ifdef MAZE
+    SCISendStr("Z\tSearch the maze and explore it on the way back\r\n");
+#endif
 
   while (1) {
         // display prompt and wait for a user input
@@ -229,9 +399,58 @@ void Debug()
                 break;
             case 'P':
                 break;
+            case 'L':
+                LoadReport();
+                break;
+            case 'M':
+                StackReport();
+                break;
+            case 'T':
+                SchedReport();
+                break;
+            case 'W':
+                if (!wallSensing) {
+                    WallInit(1);
+                }
+                WallReport();
+                break;
+            case 'G':
+                BatteryReport();
+                break;
+            case 'I':
+                ModelIdentify();
+                while (modelIdentifying) {
+                    LoadIdle(); // the ISRs drive the experiment
+                }
+                ModelReport();
+                break;
+            case 'K':
+                WheelReport();
+                break;
+            case 'U':
+                TuneStart();
+                while (tuning) {
+                    LoadIdle(); // the ISRs drive the experiment
+                }
+                TuneReport();
+                break;
+            case 'Y':
+                GeometryCalibrate();
+                break;
+            case 'H':
+                LatencyReport();
+                break;
+#ifdef MAZE
+            case 'Z':
+                MazeSearch();
+                mouseMode = MOUSE_MODE_DEBUG;
+                break;
+#endif
             case 'V':
+                ControlArc(MOTION_ARC_RADIUS);
                 break;
             case 'B':
+                ControlArc(-MOTION_ARC_RADIUS);
                 break;
             case '?':
                 break;
@@ -245,7 +464,7 @@ void Debug()
 // simple test mode for testing functions
 void Test()
 {
-  int opDelay = 10000;
+  int opDelay = 5000;    // in ms
   
   while (1) {
     ControlMouse(MOUSE_ACTION_FORWARD);
@@ -271,8 +490,12 @@ void Test()
 // ADC test mode for line following sensors
 void ADCTest()
 {
+    byte ch;
+
     while (1)
     {
-        ADCRead();
+        for (ch = 0; ch < 4; ch++) {
+            ADCRead(ch);
+        }
     }
 }
@@ -0,0 +1,260 @@
+///
+/// @file       path.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the path optimiser, which compiles the cell route of
+///             the flood-fill solver into straights, smooth turns and diagonal
+///             runs with entry and exit speeds for the fast run.
+///
+/// @remarks    Straights are measured in half cells and diagonals in diagonal
+///             steps (half the diagonal of a cell). Every turn takes up half a
+///             cell of the orthogonal straights next to it. A run of turns in
+///             consecutive cells becomes a diagonal: it is entered and left by
+///             45 degree turns, or by 135 degree turns when the first or last
+///             two turns are to the same side, and two turns to the same side
+///             in the middle of it become a 90 degree turn between diagonals.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#ifdef MAZE
+
+#define TURN_RIGHT  0x80    // in the turn list: a right turn
+#define TURN_GAP    0x7F    // in the turn list: cells moved since the previous turn
+
+
+static byte pathTurns[PATH_MAX_TURNS];  // turns of the route, see TURN_*
+
+
+/// Length of each type of segment in mm; straights and diagonals per unit.
+static const word pathLength[] = {
+    PATH_CELL_MM / 2,               // PATH_STRAIGHT, per half cell
+    PATH_CELL_MM * 707 / 1000,      // PATH_DIAGONAL, per diagonal step
+    PATH_CELL_MM * 785 / 1000,      // PATH_TURN90: quarter circle of radius 1/2 cell
+    PATH_CELL_MM * 370 / 1000,      // PATH_IN45
+    PATH_CELL_MM * 370 / 1000,      // PATH_OUT45
+    PATH_CELL_MM * 1000 / 1000,     // PATH_IN135
+    PATH_CELL_MM * 1000 / 1000,     // PATH_OUT135
+    PATH_CELL_MM * 600 / 1000       // PATH_V90
+};
+
+/// Speed limit of each type of segment in PATH_SPEED_UNIT.
+static const byte pathLimit[] = {
+    PATH_MAX_SPEED,
+    PATH_DIAGONAL_SPEED,
+    PATH_TURN90_SPEED,
+    PATH_TURN45_SPEED,
+    PATH_TURN45_SPEED,
+    PATH_TURN135_SPEED,
+    PATH_TURN135_SPEED,
+    PATH_V90_SPEED
+};
+
+
+// append a segment; returns 0 if there is no room left
+static byte Add(byte type, byte length)
+{
+    if (pathCount >= PATH_MAX_SEGMENTS) {
+        return 0;
+    }
+    pathSegments[pathCount].type = type;
+    pathSegments[pathCount].length = length;
+    pathCount++;
+    return 1;
+}
+
+
+// append a straight of 'halves' half cells, if any
+static byte AddStraight(int halves)
+{
+    return (halves > 0) ? Add(PATH_STRAIGHT, (byte)halves) : 1;
+}
+
+
+// side flag of a turn in the turn list
+static byte Side(byte turn)
+{
+    return (turn & TURN_RIGHT) ? PATH_RIGHT : 0;
+}
+
+
+// compile the turns pathTurns[first..last], taken in consecutive cells,
+// into a diagonal run, or into 90 degree turns if it is too short for one
+static byte AddTurns(byte first, byte last)
+{
+    byte in, out, p, steps, k = (byte)(last - first + 1);
+
+    in = (k >= 2 && Side(pathTurns[first]) == Side(pathTurns[first + 1])) ? 2 : 1;
+    out = (k >= 2 && Side(pathTurns[last]) == Side(pathTurns[last - 1])) ? 2 : 1;
+    if (k == 1 || in + out > k) {
+        for (p = first; p <= last; p++) {
+            if (!Add((byte)(PATH_TURN90 | Side(pathTurns[p])), 0)) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    if (!Add((byte)((in == 2 ? PATH_IN135 : PATH_IN45) | Side(pathTurns[first])), 0)) {
+        return 0;
+    }
+    steps = 1;
+    p = (byte)(first + in);
+    while (p + out <= last) {
+        if (p + out < last && Side(pathTurns[p]) == Side(pathTurns[p + 1])) {
+            if (!Add(PATH_DIAGONAL, steps) || !Add((byte)(PATH_V90 | Side(pathTurns[p])), 0)) {
+                return 0;
+            }
+            steps = 1;
+            p += 2;
+        }
+        else {
+            steps++;
+            p++;
+        }
+    }
+    return Add(PATH_DIAGONAL, steps)
+        && Add((byte)((out == 2 ? PATH_OUT135 : PATH_OUT45) | Side(pathTurns[last])), 0);
+}
+
+
+// plan entry and exit speeds with v^2 = u^2 + 2as: accelerate forwards from
+// a standing start, then limit them backwards so that the mouse can slow
+// down for every turn and stop in the centre
+static void PlanSpeeds(void)
+{
+    dword accel = 2UL * PATH_ACCEL;
+    word v, reach, limit;
+    byte i, type;
+
+    v = 0;
+    for (i = 0; i < pathCount; i++) {
+        type = pathSegments[i].type & PATH_TYPE;
+        limit = pathLimit[type];
+        pathSegments[i].entrySpeed = (byte)(v < limit ? v : limit);
+        if (type == PATH_STRAIGHT || type == PATH_DIAGONAL) {
+            reach = FixSqrt((dword)pathSegments[i].entrySpeed * pathSegments[i].entrySpeed
+                + accel * PathSegmentLength(i) / ((dword)PATH_SPEED_UNIT * PATH_SPEED_UNIT));
+            v = (reach < limit) ? reach : limit;
+        }
+        else {
+            v = pathSegments[i].entrySpeed;
+        }
+        pathSegments[i].exitSpeed = (byte)v;
+    }
+
+    v = 0;
+    i = pathCount;
+    while (i-- > 0) {
+        type = pathSegments[i].type & PATH_TYPE;
+        if (pathSegments[i].exitSpeed > v) {
+            pathSegments[i].exitSpeed = (byte)v;
+        }
+        if (type == PATH_STRAIGHT || type == PATH_DIAGONAL) {
+            reach = FixSqrt((dword)pathSegments[i].exitSpeed * pathSegments[i].exitSpeed
+                + accel * PathSegmentLength(i) / ((dword)PATH_SPEED_UNIT * PATH_SPEED_UNIT));
+        }
+        else {
+            reach = pathSegments[i].exitSpeed;
+        }
+        if (pathSegments[i].entrySpeed > reach) {
+            pathSegments[i].entrySpeed = (byte)reach;
+        }
+        v = pathSegments[i].entrySpeed;
+    }
+}
+
+
+// length of segment 'index' in mm
+word PathSegmentLength(byte index)
+{
+    byte type = pathSegments[index].type & PATH_TYPE;
+
+    if (type == PATH_STRAIGHT || type == PATH_DIAGONAL) {
+        return pathLength[type] * pathSegments[index].length;
+    }
+    return pathLength[type];
+}
+
+
+// compile the turns pathTurns[0..turns - 1], followed by 'gap' cells to the
+// centre, into pathSegments; returns 0 if they do not fit
+static byte Compile(byte turns, byte gap, byte diagonals)
+{
+    byte first, last, ok = 1;
+    int halves;
+
+    // a turn takes up half a cell before and after the cell centre
+    pathCount = 0;
+    halves = 0;
+    first = 0;
+    while (ok && first < turns) {
+        last = first;
+        if (diagonals) {
+            while (last + 1 < turns && (pathTurns[last + 1] & TURN_GAP) == 1) {
+                last++;
+            }
+        }
+        halves += 2 * (pathTurns[first] & TURN_GAP) - 1;
+        ok = AddStraight(halves) && AddTurns(first, last);
+        halves = -1;
+        first = (byte)(last + 1);
+    }
+    return ok && AddStraight(halves + 2 * gap);
+}
+
+
+// compile the route from the start to the centre given by mazeDist (see
+// MazeFlood()) into pathSegments; without 'diagonals' only straights and
+// 90 degree turns are used. A route whose diagonal runs do not fit is
+// compiled without them. Returns 0 if there is no route or it is still too
+// long; the mouse then drives it cell by cell with MazeStep().
+byte PathCompile(byte diagonals)
+{
+    byte savedCell = mazeCell, savedHeading = mazeHeading;
+    byte dir, turns = 0, gap = 0, ok = 1;
+
+    pathCount = 0;
+    if (mazeDist[MAZE_START] == MAZE_UNREACHED) {
+        return 0;
+    }
+
+    // follow the distances down to the centre and note where the route turns
+    mazeCell = MAZE_START;
+    mazeHeading = MAZE_DIR_NORTH;
+    while (!MazeIsGoal(mazeCell)) {
+        dir = MazeNextDirection();
+        if (dir != mazeHeading) {
+            if (dir == MAZE_OPPOSITE(mazeHeading) || turns >= PATH_MAX_TURNS) {
+                ok = 0;
+                break;
+            }
+            pathTurns[turns++] = (byte)(gap | (dir == ((mazeHeading + 1) & 0x03) ? TURN_RIGHT : 0));
+            gap = 0;
+        }
+        MazeMove(dir);
+        gap++;
+    }
+    mazeCell = savedCell;
+    mazeHeading = savedHeading;
+
+    if (ok) {
+        ok = Compile(turns, gap, diagonals) || (diagonals && Compile(turns, gap, 0));
+    }
+    if (!ok) {
+        pathCount = 0;
+        return 0;
+    }
+
+    PlanSpeeds();
+    return 1;
+}
+
+#endif  // MAZE
@@ -0,0 +1,174 @@
+///
+/// @file       MC9S08AW60.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      SDCC replacement for the CodeWarrior peripheral header of the
+///             MC9S08AW60; maps the registers used by the firmware onto
+///             their absolute addresses.
+///
+/// @remarks    Only the registers and bits used by the firmware are declared;
+///             addresses follow the register summary of the MC9S08AW60 data
+///             sheet. When S08_STUB_PERIPHERALS is defined (emulator builds),
+///             the status bits that the firmware polls read as always set,
+///             because the instruction-set emulator has no peripheral models.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _S08_MC9S08AW60_H
+#define _S08_MC9S08AW60_H
+
+
+typedef unsigned char byte;
+typedef unsigned int word;
+typedef unsigned long dword;
+
+
+//------------------------------------------------------------------------------
+//  Interrupt vectors; the handlers are in 'vectors.c'
+//------------------------------------------------------------------------------
+#define VectorNumber_Vkeyboard1
+#define VectorNumber_Vtpm2ovf
+#define VectorNumber_Vtpm2ch0
+#define VectorNumber_Vtpm2ch1
+#define VectorNumber_Vsci2tx
+
+/// @name Vector numbers as used by SDCC's __interrupt(n) (address 0xFFFE - 2n)
+//@{
+#define S08_VECTOR_TPM2CH0      12
+#define S08_VECTOR_TPM2CH1      13
+#define S08_VECTOR_TPM2OVF      14
+#define S08_VECTOR_SCI2TX       21
+#define S08_VECTOR_KEYBOARD1    22
+//@}
+
+
+//------------------------------------------------------------------------------
+//  Registers
+//------------------------------------------------------------------------------
+typedef union {
+    byte Byte;
+    struct {
+        byte BIT0:1;
+        byte BIT1:1;
+        byte BIT2:1;
+        byte BIT3:1;
+        byte BIT4:1;
+        byte BIT5:1;
+        byte BIT6:1;
+        byte BIT7:1;
+    } Bits;
+} S08Reg8;
+
+#define S08_REG8(addr)          (*(volatile byte *)(addr))
+#define S08_REG16(addr)         (*(volatile word *)(addr))
+#define S08_BIT(addr, bit)      (((volatile S08Reg8 *)(addr))->Bits.bit)
+
+/// @name Parallel I/O
+//@{
+#define PTAD        S08_REG8(0x0000)
+#define PTAD_PTAD0  S08_BIT(0x0000, BIT0)
+#define PTAD_PTAD1  S08_BIT(0x0000, BIT1)
+#define PTAD_PTAD2  S08_BIT(0x0000, BIT2)
+#define PTAD_PTAD3  S08_BIT(0x0000, BIT3)
+#define PTAD_PTAD4  S08_BIT(0x0000, BIT4)
+#define PTAD_PTAD5  S08_BIT(0x0000, BIT5)
+#define PTAD_PTAD6  S08_BIT(0x0000, BIT6)
+#define PTAD_PTAD7  S08_BIT(0x0000, BIT7)
+#define PTADD       S08_REG8(0x0001)
+#define PTBD        S08_REG8(0x0002)
+#define PTBD_PTBD0  S08_BIT(0x0002, BIT0)
+#define PTBD_PTBD1  S08_BIT(0x0002, BIT1)
+#define PTBD_PTBD2  S08_BIT(0x0002, BIT2)
+#define PTBD_PTBD3  S08_BIT(0x0002, BIT3)
+#define PTCD        S08_REG8(0x0004)
+#define PTCD_PTCD2  S08_BIT(0x0004, BIT2)
+#define PTCD_PTCD4  S08_BIT(0x0004, BIT4)
+#define PTCD_PTCD6  S08_BIT(0x0004, BIT6)
+#define PTCDD       S08_REG8(0x0005)
+#define PTDD        S08_REG8(0x0006)
+#define PTDD_PTDD2  S08_BIT(0x0006, BIT2)
+#define PTDD_PTDD3  S08_BIT(0x0006, BIT3)
+#define PTAPE       S08_REG8(0x1840)
+//@}
+
+/// @name System control and clock generation
+//@{
+#define SOPT            S08_REG8(0x1802)
+#define ICGC1           S08_REG8(0x0048)
+#define ICGC2           S08_REG8(0x0049)
+#define ICGS1           S08_REG8(0x004A)
+#ifdef S08_STUB_PERIPHERALS
+#define ICGS1_LOCK      1
+#else
+#define ICGS1_LOCK      S08_BIT(0x004A, BIT3)
+#endif
+//@}
+
+/// @name Keyboard interrupt
+//@{
+#define KBI1SC          S08_REG8(0x001E)
+#define KBI1SC_KBACK    S08_BIT(0x001E, BIT2)
+//@}
+
+/// @name Timer/PWM modules
+//@{
+#define TPM1SC          S08_REG8(0x0020)
+#define TPM1SC_TOF      S08_BIT(0x0020, BIT7)
+#define TPM1MOD         S08_REG16(0x0023)
+#define TPM1C2SC        S08_REG8(0x002B)
+#define TPM1C2V         S08_REG16(0x002C)
+#define TPM1C3SC        S08_REG8(0x002E)
+#define TPM1C3V         S08_REG16(0x002F)
+#define TPM1C4SC        S08_REG8(0x0031)
+#define TPM1C4V         S08_REG16(0x0032)
+#define TPM1C5SC        S08_REG8(0x0034)
+#define TPM1C5V         S08_REG16(0x0035)
+#define TPM2SC          S08_REG8(0x0060)
+#define TPM2SC_TOF      S08_BIT(0x0060, BIT7)
+#define TPM2CNT         S08_REG16(0x0061)
+#define TPM2MOD         S08_REG16(0x0063)
+#define TPM2C0SC        S08_REG8(0x0065)
+#define TPM2C0SC_CH0F   S08_BIT(0x0065, BIT7)
+#define TPM2C0V         S08_REG16(0x0066)
+#define TPM2C1SC        S08_REG8(0x0068)
+#define TPM2C1SC_CH1F   S08_BIT(0x0068, BIT7)
+#define TPM2C1V         S08_REG16(0x0069)
+//@}
+
+/// @name Analog-to-digital converter
+//@{
+#define ADC1SC1         S08_REG8(0x0010)
+#define ADC1RH          S08_REG8(0x0012)
+#define ADC1RL          S08_REG8(0x0013)
+#define ADC1CFG         S08_REG8(0x0016)
+#define APCTL1          S08_REG8(0x0017)
+#ifdef S08_STUB_PERIPHERALS
+#define ADC1SC1_COCO    1
+#else
+#define ADC1SC1_COCO    S08_BIT(0x0010, BIT7)
+#endif
+//@}
+
+/// @name Serial communication interface
+//@{
+#define SCI2BD          S08_REG16(0x0040)
+#define SCI2C2          S08_REG8(0x0043)
+#define SCI2S1          S08_REG8(0x0044)
+#define SCI2D           S08_REG8(0x0047)
+#define SCI2C2_TIE      S08_BIT(0x0043, BIT7)
+#ifdef S08_STUB_PERIPHERALS
+#define SCI2S1_TDRE     1
+#define SCI2S1_RDRF     1
+#else
+#define SCI2S1_TDRE     S08_BIT(0x0044, BIT7)
+#define SCI2S1_RDRF     S08_BIT(0x0044, BIT5)
+#endif
+//@}
+
+
+#endif  // _S08_MC9S08AW60_H
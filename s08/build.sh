@@ -0,0 +1,83 @@
+#!/bin/sh
+#
+# @file       build.sh
+# @author     agent <agent@local>
+# @date       2026-10-19
+#
+# @brief      Builds the firmware with SDCC for the S08 core on Linux.
+#
+# @remarks    Produces 'mouse.ihx', the firmware as built from 'main.c', and
+#             'profile.ihx', the emulator image of 'profile.c' for
+#             'cycles.py'; both in the build directory (default 's08/build').
+#             Extra compiler options, e.g. '-DCLOCK_PROFILE=CLOCK_20MHZ', are
+#             taken from CFLAGS; the profile image always has MAZE defined,
+#             for MazeFlood(). The build fails if either image links
+#             floating-point routines, or if the firmware image has no
+#             interrupt vectors. Usage: s08/build.sh [build_dir]
+#
+# @copyright  This software is written and distributed under the GNU General
+#             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+#             You must not remove this notice, or any other, from this software.
+#
+
+set -e
+
+TOP=$(cd "$(dirname "$0")/.." && pwd)
+OUT=${1:-$TOP/s08/build}
+SDCC=${SDCC:-sdcc}
+
+# sources shared by both images; Start08.c is replaced by SDCC's own startup
+SOURCES="setup.c isr.c motor_control.c mouse_control.c mouse_operation.c \
+motion.c input.c load.c stack.c sched.c trace.c wall.c battery.c model.c wheel.c heading.c tune.c geometry.c combat.c latency.c maze.c path.c fixed.c serial_interface.c util.c"
+
+# MC9S08AW60 memory map: direct page RAM from 0x0070, the rest of the 2 KB
+# RAM up to 0x086F holds other data and the stack; flash from 0x1860
+ARCH="-ms08 --std-c99 --opt-code-speed"
+LAYOUT="--data-loc 0x0070 --xram-loc 0x0100 --stack-loc 0x086F --code-loc 0x1860"
+
+# compile 'src' into '$OUT/name.rel' with the given extra options
+compile() {
+    src=$1; name=$2; shift 2
+    "$SDCC" $ARCH -I"$TOP/s08" -I"$TOP" $CFLAGS "$@" -c "$src" -o "$OUT/$name.rel"
+}
+
+mkdir -p "$OUT/fw" "$OUT/prof"
+
+for src in $SOURCES; do
+    name=$(basename "$src" .c)
+    compile "$TOP/$src" "fw/$name"
+    compile "$TOP/$src" "prof/$name" -DS08_STUB_PERIPHERALS -DMAZE
+done
+compile "$TOP/main.c" fw/main
+compile "$TOP/s08/vectors.c" fw/vectors
+compile "$TOP/s08/profile.c" prof/profile -DS08_STUB_PERIPHERALS -DMAZE
+
+# the module holding main() has to come first
+FW="$OUT/fw/main.rel $OUT/fw/vectors.rel"
+PROF="$OUT/prof/profile.rel"
+for src in $SOURCES; do
+    name=$(basename "$src" .c)
+    FW="$FW $OUT/fw/$name.rel"
+    PROF="$PROF $OUT/prof/$name.rel"
+done
+
+"$SDCC" $ARCH $LAYOUT --out-fmt-ihx -o "$OUT/mouse.ihx" $FW
+"$SDCC" $ARCH $LAYOUT --out-fmt-ihx -o "$OUT/profile.ihx" $PROF
+
+# the firmware must not pull in SDCC's soft-float library (___fsmul,
+# ___sint2fs, ...); use the fixed-point functions of 'fixed.c' instead
+for map in "$OUT/mouse.map" "$OUT/profile.map"; do
+    if grep -E '___fs|2fs\b' "$map"; then
+        echo "$map: floating-point routines linked" >&2
+        exit 1
+    fi
+done
+
+# the vector table sits at the top of the flash, from 0xFFC0; SDCC leaves
+# it out when main.c does not see the handlers of 'vectors.h'
+if ! grep -Eq '^:[0-9A-Fa-f]{2}FF[C-Fc-f]' "$OUT/mouse.ihx"; then
+    echo "$OUT/mouse.ihx: no interrupt vectors" >&2
+    exit 1
+fi
+
+echo "built $OUT/mouse.ihx and $OUT/profile.ihx"
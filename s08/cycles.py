@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# @file       cycles.py
+# @author     agent <agent@local>
+# @date       2026-10-19
+#
+# @brief      Runs the profiling image built by 'build.sh' in the uCsim S08
+#             emulator and reports the cycles spent in each phase of
+#             'profile.c'.
+#
+# @remarks    Breakpoints are set on ProfileBegin() and ProfileEnd(); at each
+#             stop the emulator's clock count is read, and the cost of an
+#             empty phase is subtracted from the others. The worst case of
+#             each phase is also given as a share of the scheduler tick,
+#             tickPeriod in 'mouse.h'; the Tick* phases must stay below
+#             100%, or ticks are lost. Usage:
+#             cycles.py [-u ucsim] [-t type] [-b busclock_hz] [build_dir]
+#
+# @copyright  This software is written and distributed under the GNU General
+#             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+#             You must not remove this notice, or any other, from this software.
+#
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def phases():
+    """Phase names and calls per phase, read from 'profile.c'."""
+    with open(os.path.join(HERE, 'profile.c')) as f:
+        source = f.read()
+    names = re.findall(r'//\s*Phase(\w+)', source)
+    calls = int(re.search(r'#define\s+PROFILE_CALLS\s+(\d+)', source).group(1))
+    return names, calls
+
+
+def tick_us():
+    """Scheduler tick in microseconds, read from 'mouse.h'."""
+    with open(os.path.join(HERE, '..', 'mouse.h')) as f:
+        source = f.read()
+    return 1000.0 * int(re.search(r'#define\s+tickPeriod\s+(\d+)', source).group(1))
+
+
+def symbols(build):
+    """Symbol addresses from the linker's NoICE file or, failing that, map."""
+    table = {}
+    noi = os.path.join(build, 'profile.noi')
+    if os.path.exists(noi):
+        for line in open(noi):
+            m = re.match(r'\s*DEF\s+(\w+)\s+0x([0-9A-Fa-f]+)', line)
+            if m:
+                table[m.group(1)] = int(m.group(2), 16)
+    else:
+        for line in open(os.path.join(build, 'profile.map')):
+            m = re.match(r'\s*(?:C:)?\s*([0-9A-Fa-f]{4,8})\s+(_\w+)', line)
+            if m:
+                table[m.group(2)] = int(m.group(1), 16)
+    return table
+
+
+class Emulator:
+    """uCsim driven through its command console on stdin/stdout."""
+
+    def __init__(self, ucsim, cpu, image):
+        self.proc = subprocess.Popen([ucsim, '-t', cpu, image],
+                                     stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT, text=True, bufsize=0)
+        self.read()
+
+    def read(self):
+        out = ''
+        while not re.search(r'(^|\n)\d*> $', out):
+            ch = self.proc.stdout.read(1)
+            if not ch:
+                raise RuntimeError('emulator exited:\n' + out)
+            out += ch
+        return out
+
+    def command(self, line):
+        self.proc.stdin.write(line + '\n')
+        return self.read()
+
+    def clocks(self):
+        m = re.search(r'\((\d+) clks\)', self.command('state'))
+        return int(m.group(1))
+
+    def close(self):
+        self.proc.stdin.write('quit\n')
+        self.proc.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Cycle counts of the profile.c phases')
+    parser.add_argument('build', nargs='?', default=os.path.join(HERE, 'build'))
+    parser.add_argument('-u', '--ucsim', default='ucsim_hc08')
+    parser.add_argument('-t', '--type', default='HCS08', help='uCsim CPU type')
+    parser.add_argument('-b', '--bus', type=float, default=20e6, help='bus clock in Hz')
+    args = parser.parse_args()
+
+    names, calls = phases()
+    tick = tick_us()
+    table = symbols(args.build)
+    begin, end = table['_ProfileBegin'], table['_ProfileEnd']
+
+    emu = Emulator(args.ucsim, args.type, os.path.join(args.build, 'profile.ihx'))
+    emu.command('break 0x%04x' % begin)
+    emu.command('break 0x%04x' % end)
+
+    samples = []
+    for name in names:
+        cycles = []
+        for _ in range(calls):
+            emu.command('run')
+            start = emu.clocks()
+            emu.command('run')
+            cycles.append(emu.clocks() - start)
+        samples.append((name, cycles))
+    emu.close()
+
+    overhead = min(samples[0][1])
+    print('%-24s %8s %8s %8s %10s %7s' % ('phase', 'min', 'avg', 'max', 'max us', 'tick'))
+    for name, cycles in samples[1:]:
+        cycles = [c - overhead for c in cycles]
+        us = max(cycles) * 1e6 / args.bus
+        print('%-24s %8d %8d %8d %10.1f %6.1f%%' % (name, min(cycles), sum(cycles) // len(cycles),
+                                                   max(cycles), us, 100.0 * us / tick))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,27 @@
+///
+/// @file       hidef.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      SDCC replacement for the CodeWarrior 'hidef.h' used when the
+///             firmware is built with the open S08 toolchain.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _S08_HIDEF_H
+#define _S08_HIDEF_H
+
+
+#define EnableInterrupts    __asm__("cli")
+#define DisableInterrupts   __asm__("sei")
+
+/// SDCC has no prefix form of 'interrupt'; the firmware ISRs compile as
+/// ordinary functions and are called from the handlers in 'vectors.c'.
+#define interrupt
+
+
+#endif  // _S08_HIDEF_H
@@ -0,0 +1,226 @@
+///
+/// @file       profile.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Profiling harness run in the S08 emulator in place of
+///             'main.c'; calls each measured function between the markers
+///             ProfileBegin() and ProfileEnd().
+///
+/// @remarks    'cycles.py' breaks on the two markers, reads the emulator's
+///             cycle counter at each and names the phases from the 'phases'
+///             table below, so keep its 'Phase*' entries one per line and in
+///             order. Every phase is run PROFILE_CALLS times; its setup
+///             function runs outside the markers and varies the inputs.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#define MAIN_PROGRAM	// to define global variables only once
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#define PROFILE_CALLS   16  ///< calls per phase
+
+
+typedef struct {
+    void (*setup)(byte n);  ///< prepares call 'n'; not measured
+    void (*run)(void);      ///< the measured call
+} ProfilePhase;
+
+
+static byte walls[] = { 0x00, MAZE_NORTH, MAZE_EAST | MAZE_WEST, MAZE_SOUTH };
+
+/// touch bar and infrared bit patterns for the obstacle avoiding step
+static byte sensors[] = { 0x00, 0x02, 0x04, 0x06, 0x40, 0x80, 0xC0, 0xC6 };
+
+
+// the markers; kept out of line so that the emulator can break on them
+void ProfileBegin(void)
+{
+}
+
+
+void ProfileEnd(void)
+{
+}
+
+
+static void SetupNothing(byte n)
+{
+    (void)n;
+}
+
+
+static void RunNothing(void)
+{
+}
+
+
+static void SetupSpeed(byte n)
+{
+    leftMotor = MOTOR_STATUS_FORWARD;
+    rightMotor = MOTOR_STATUS_FORWARD;
+    mouseStatus = MOUSE_STATUS_FORWARD;
+    diffLeft = (word)(nomSpeed + (n & 7) * 64);
+    diffRight = (word)(nomSpeed - (n & 3) * 128);
+}
+
+
+static void RunControlMotor(void)
+{
+    ControlMotor(MOTOR_LEFT, MOTOR_ACTION_FORWARD);
+}
+
+
+static void SetupTachometer(byte n)
+{
+    travelDistance = 100;
+    TPM2C0V += (word)(nomSpeed + n);
+    TPM2C1V += (word)(nomSpeed - n);
+}
+
+
+static void SetupSense(byte n)
+{
+    if (n == 0) {
+        WallInit(1);    // the samples alternate between ambient and lit
+    }
+    ADC1RL = (byte)(n * 16);
+}
+
+
+static void SetupIdentify(byte n)
+{
+    SetupSpeed(n);
+    if (n == 0) {
+        ModelIdentify();    // the calls step through the first periods of the experiment
+    }
+}
+
+
+static void SetupNavigate(byte n)
+{
+    SetupSpeed(n);
+    modelIdentifying = 0;
+    MotionClear();
+    MotionPush((n & 1) ? MOTION_ARC : MOTION_MOVE, (n & 1) ? 90 : 180);   // started by this call
+}
+
+
+// the heaviest ticks: wall sensing runs in every tick, and the control and
+// navigation tasks at different offsets
+static void RunTickControl(void)
+{
+    TaskSense();
+    TaskControl();
+}
+
+
+static void RunTickNavigate(void)
+{
+    TaskSense();
+    TaskNavigate();
+}
+
+
+static void SetupSwitches(byte n)
+{
+    PTDD = (n & 1) ? 0x04 : 0x08;   // SW3 and SW4 pressed in turn
+}
+
+
+static void SetupAvoid(byte n)
+{
+    MotionClear();
+    PTAD = sensors[n & 7];
+}
+
+
+static void SetupLine(byte n)
+{
+    ADC1RL = (byte)(n * 16);
+}
+
+
+static void SetupMaze(byte n)
+{
+    byte i;
+
+    MazeInit();
+    for (i = 0; i < MAZE_CELLS; i += 3) {
+        MazeSetWalls(i, walls[(i + n) & 3]);
+    }
+}
+
+
+static void RunMazeFlood(void)
+{
+    MazeFlood(0);
+}
+
+
+static volatile Q16_16 fixResult;
+
+static void RunFixMul16(void)
+{
+    fixResult = FixMul16(0x00345678L, -0x00012345L);
+}
+
+
+static void RunFixDiv16(void)
+{
+    fixResult = FixDiv16(0x00345678L, -0x00012345L);
+}
+
+
+static void RunFixAtan2(void)
+{
+    fixResult = FixAtan2(-1234, 5678);
+}
+
+
+static const ProfilePhase phases[] = {
+    { SetupNothing, RunNothing },               // PhaseOverhead
+    { SetupSpeed, RunControlMotor },            // PhaseControlMotor
+    { SetupSpeed, ControlSpeed },               // PhaseControlSpeed
+    { SetupSpeed, intTPM2OVF },                 // PhaseTPM2OVF
+    { SetupTachometer, intTPM2CH0 },            // PhaseTPM2CH0
+    { SetupTachometer, intTPM2CH1 },            // PhaseTPM2CH1
+    { SetupSense, TaskSense },                  // PhaseTaskSense
+    { SetupSwitches, TaskInput },               // PhaseTaskInput
+    { SetupSpeed, TaskControl },                // PhaseTaskControl
+    { SetupIdentify, TaskControl },             // PhaseTaskControlIdentify
+    { SetupNavigate, TaskNavigate },            // PhaseTaskNavigate
+    { SetupSpeed, RunTickControl },             // PhaseTickControl
+    { SetupNavigate, RunTickNavigate },         // PhaseTickNavigate
+    { SetupAvoid, AvoidObstacleStep },          // PhaseAvoidObstacleStep
+    { SetupLine, LineFollowingStep },           // PhaseLineFollowingStep
+    { SetupMaze, RunMazeFlood },                // PhaseMazeFlood
+    { SetupNothing, RunFixMul16 },              // PhaseFixMul16
+    { SetupNothing, RunFixDiv16 },              // PhaseFixDiv16
+    { SetupNothing, RunFixAtan2 }               // PhaseFixAtan2
+};
+
+
+void main(void)
+{
+    byte i, n;
+
+    MouseSetup();   // no interrupts: the phases call the ISRs themselves
+
+    for (i = 0; i < sizeof(phases) / sizeof(phases[0]); i++) {
+        for (n = 0; n < PROFILE_CALLS; n++) {
+            phases[i].setup(n);
+            ProfileBegin();
+            phases[i].run();
+            ProfileEnd();
+        }
+    }
+
+    for (;;) {
+    }
+}
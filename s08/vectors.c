@@ -0,0 +1,53 @@
+///
+/// @file       vectors.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Interrupt handlers for the SDCC build; each one enters the
+///             firmware ISR of the same vector.
+///
+/// @remarks    CodeWarrior places the ISRs through 'interrupt n' prefixes,
+///             which SDCC does not accept, so the firmware ISRs are ordinary
+///             functions here and these handlers add one JSR/RTS (11 cycles)
+///             on top of what the CodeWarrior build spends.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+#include "vectors.h"	// for the declaration of the handlers
+
+
+void vecKeyboard1(void) __interrupt(S08_VECTOR_KEYBOARD1)
+{
+    intSW3_4();
+}
+
+
+void vecTPM2CH0(void) __interrupt(S08_VECTOR_TPM2CH0)
+{
+    intTPM2CH0();
+}
+
+
+void vecTPM2CH1(void) __interrupt(S08_VECTOR_TPM2CH1)
+{
+    intTPM2CH1();
+}
+
+
+void vecTPM2OVF(void) __interrupt(S08_VECTOR_TPM2OVF)
+{
+    intTPM2OVF();
+}
+
+
+#ifdef TRACE
+void vecSCI2TX(void) __interrupt(S08_VECTOR_SCI2TX)
+{
+    intSCI2TX();
+}
+#endif
@@ -0,0 +1,33 @@
+///
+/// @file       vectors.h
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Declares the interrupt handlers of 'vectors.c' for the SDCC
+///             build.
+///
+/// @remarks    SDCC builds the vector table from the __interrupt(n)
+///             functions declared in the module that holds main(), so
+///             'main.c' has to include this header; without it the image
+///             has no interrupt vectors at all. 'build.sh' checks for them.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#ifndef _S08_VECTORS_H
+#define _S08_VECTORS_H
+
+
+void vecKeyboard1(void) __interrupt(S08_VECTOR_KEYBOARD1);
+void vecTPM2CH0(void) __interrupt(S08_VECTOR_TPM2CH0);
+void vecTPM2CH1(void) __interrupt(S08_VECTOR_TPM2CH1);
+void vecTPM2OVF(void) __interrupt(S08_VECTOR_TPM2OVF);
+#ifdef TRACE
+void vecSCI2TX(void) __interrupt(S08_VECTOR_SCI2TX);
+#endif
+
+
+#endif  // _S08_VECTORS_H
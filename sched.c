@@ -0,0 +1,191 @@
+///
+/// @file       sched.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the multi-rate scheduler run by the TPM2 overflow
+///             ISR, and the periodic tasks it runs.
+///
+/// @remarks    schedTable lists every task with its period and its offset
+///             in ticks; the offsets spread tasks of the same rate over
+///             different ticks. Tasks run to completion in the tick ISR, so
+///             each one must finish well within a tick. A task that is still
+///             running when the next tick is due counts an overrun, and the
+///             longest run of each task is kept for SchedReport(). TOF
+///             latches one wrap only, so after an overrun further ticks may
+///             have been lost and the times may be whole ticks short; the
+///             tick is kept in schedSlip, and the tachometer ISRs drop the
+///             periods that span it. Work that
+///             has no period (the mode loops, the debug command line) runs in
+///             the background, in main().
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+typedef struct {
+    void (*run)(void);
+    byte period;        // ticks between runs
+    byte offset;        // tick of the first run
+} SchedEntry;
+
+static const SchedEntry schedTable[SCHED_TASKS] = {
+    { TaskSense, SCHED_TICKS(sensePeriod), 0 },         // SCHED_SENSE
+    { TaskInput, SCHED_TICKS(inputPeriod), 1 },         // SCHED_INPUT
+    { TaskControl, SCHED_TICKS(controlPeriod), 2 },     // SCHED_CONTROL
+    { TaskNavigate, SCHED_TICKS(navigatePeriod), 3 }    // SCHED_NAVIGATE
+};
+
+static byte schedDue[SCHED_TASKS];  // ticks until the next run of each task
+
+
+// start every task at its offset and clear the statistics
+void SchedInit(void)
+{
+    byte i;
+
+    schedTicks = 0;
+    schedSlip = 0;
+    for (i = 0; i < SCHED_TASKS; i++) {
+        schedDue[i] = (byte)(schedTable[i].offset % schedTable[i].period + 1);
+        schedWorst[i] = 0;
+        schedOverruns[i] = 0;
+    }
+}
+
+
+// run the tasks due in this tick; called by the TPM2 overflow ISR
+void SchedTick(void)
+{
+    byte i, late;
+    word start, now;
+
+    schedTicks++;
+    for (i = 0; i < SCHED_TASKS; i++) {
+        if (--schedDue[i] != 0) {
+            continue;
+        }
+        schedDue[i] = schedTable[i].period;
+
+        late = TPM2SC_TOF;
+        start = TPM2CNT;
+        schedTable[i].run();
+        now = TPM2CNT;
+        if (now < start) {
+            now += TPM2MOD + 1;     // the counter wrapped at TPM2MOD
+        }
+        if (TPM2SC_TOF) {
+            schedSlip = schedTicks; // the tachometer periods over this tick are unreliable
+            if (!late && schedOverruns[i] != 0xFF) {
+                schedOverruns[i]++; // the next tick came due while this task ran
+            }
+        }
+        if (now - start > schedWorst[i]) {
+            schedWorst[i] = now - start;
+        }
+    }
+}
+
+
+// report the longest run and the overruns of each task on the SCI
+void SchedReport(void)
+{
+    static char *names[] = { "Sense    ", "Input    ", "Control  ", "Navigate " };
+    byte i;
+
+    for (i = 0; i < SCHED_TASKS; i++) {
+        SCISendStr(names[i]);
+        SCISendDec((word)((dword)schedWorst[i] * (tickPeriod * 1000UL) / ((dword)TPM2_MOD + 1)));
+        SCISendStr(" us, ");
+        SCISendDec(schedOverruns[i]);
+        SCISendStr(" overruns\r\n");
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Tasks
+//------------------------------------------------------------------------------
+// step a motor through stop, forward and reverse on each press of its switch
+static void ToggleMotor(Motor motor, MotorStatus status)
+{
+    // a motor that brakes for a reversal stops
+    switch (status) {
+    case MOTOR_STATUS_STOP:
+        ControlMotor(motor, MOTOR_ACTION_FORWARD);
+        break;
+    case MOTOR_STATUS_FORWARD:
+        ControlMotor(motor, MOTOR_ACTION_REVERSE);
+        break;
+    case MOTOR_STATUS_REVERSE:
+    case MOTOR_STATUS_BRAKE:
+        ControlMotor(motor, MOTOR_ACTION_STOP);
+        break;
+    }
+}
+
+
+// read the analog IR sensors
+void TaskSense(void)
+{
+    WallSample();
+}
+
+
+// debounce the digital inputs and react to them in the combat mode; a press
+// of SW3 or SW4 toggles the left or right motor
+void TaskInput(void)
+{
+    byte changed;
+
+    TRACE_RECORD(TRACE_INPUTS, ((word)PTAD << 8) | PTDD);
+    changed = InputSample();
+    if (changed & inputLevels & INPUT_SW3) {
+        ToggleMotor(MOTOR_LEFT, leftMotor);
+    }
+    if (changed & inputLevels & INPUT_SW4) {
+        ToggleMotor(MOTOR_RIGHT, rightMotor);
+    }
+    CombatStep();
+}
+
+
+// check the wheels for slip and stall, drive the braked motors of reversals
+// the new way once their wheels stand still, then balance the speeds of the
+// motors when both are driven, or identify their models, tune them or drive
+// a charge or a push of the combat mode
+void TaskControl(void)
+{
+    WheelCheck();
+    ControlReversal();
+    if (modelIdentifying) {
+        ModelIdentifyStep();
+    }
+    else if (tuning) {
+        TuneStep();
+    }
+    else if (combatState == COMBAT_CHARGE || combatState == COMBAT_PUSH) {
+        CombatDrive();
+    }
+    else if ((leftMotor == MOTOR_STATUS_FORWARD || leftMotor == MOTOR_STATUS_REVERSE)
+             && (rightMotor == MOTOR_STATUS_FORWARD || rightMotor == MOTOR_STATUS_REVERSE)) {
+        ControlSpeed();
+    }
+    TRACE_RECORD(TRACE_PERIOD, (pwLeft << 8) | (pwRight & 0xFF));
+}
+
+
+// start the next queued motion command when the current one is done, and
+// check the CPU load, the stack and the battery
+void TaskNavigate(void)
+{
+    LoadPeriod();       // close the CPU load measurement of the last navigation period
+    StackCheck();       // warn before the stack overflows
+    BatterySample();    // scale the duty cycles for the battery voltage
+    MotionService(1);
+}
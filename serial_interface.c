@@ -19,11 +19,8 @@
 // setup SCI module
 void SCISetup()
 {
-/*
-    ICGC1   = 0b01110100;   // select external crystal;
-    ICGC2   = 0x30;   // multiply by 10; ICGC1 and ICGC2 specify 20 MHz bus clock
-*/    
-    SCI2BD = 0x000D;    // 9600 baud with the bus clock of 2 MHz
+    // the bus clock has been set up by MouseSetup() according to CLOCK_PROFILE
+    SCI2BD = (word)SCI_BD;  // baudRate with the bus clock of the clock profile
     SCI2C2 = 0b00001100;    // Turn on TX (TE=1) and RX (RE=1) with polling
 
 /*
@@ -41,7 +38,7 @@ byte SCIReceiveChar()
     byte ch;
   
     while (SCI2S1_RDRF != 1) {
-        // wait for data
+        LoadIdle(); // wait for data
     }
     ch = SCI2S1;  // clear the RDRF flag
     ch = SCI2D;   // read the character
@@ -107,3 +104,46 @@ void SCISendNewLine()
 {
     SCISendStr("\r\n");
 }
+
+
+// send an unsigned number in decimal
+void SCISendDec(word value)
+{
+    char digits[6];
+    byte i = sizeof(digits) - 1;
+
+    digits[i] = '\0';
+    do {
+        digits[--i] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    SCISendStr(&digits[i]);
+}
+
+
+// receive a signed number in decimal, ended by a carriage return or line
+// feed, echoing the characters that make it up; others are ignored
+int SCIGetDec(void)
+{
+    byte ch, negative = 0;
+    int value = 0;
+
+    while (1) {
+        ch = SCIReceiveChar();
+        if (ch == '\r' || ch == '\n') {
+            break;
+        }
+        if (ch == '-' && value == 0 && !negative) {
+            negative = 1;
+        }
+        else if (ch >= '0' && ch <= '9' && value <= 3275) {
+            value = value * 10 + (ch - '0');
+        }
+        else {
+            continue;
+        }
+        SCISendChar(ch);
+    }
+    SCISendNewLine();
+    return negative ? -value : value;
+}
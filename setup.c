@@ -0,0 +1,88 @@
+///
+/// @file       setup.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the initialisation of peripherals and control
+///             variables shared by the firmware and the host simulator.
+///
+/// @remarks    The initialisation was moved here from main() in 'main.c'.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+// initialise peripherals and control variables; called with interrupts disabled
+void MouseSetup(void)
+{
+    SOPT = 0x00; //disable watchdog
+    
+    ICGC2 = icgc2Value; // FLL multiplier and reference divider of the clock profile
+    ICGC1 = icgc1Value; // select external crystal
+#if clockUsesFLL
+    while (ICGS1_LOCK == 0) {
+        // wait for the FLL to lock
+    }
+#endif
+    Delay(32);  // start up delay for crystal
+    SCISetup(); // setup serial communication via RS-232 I/F
+    
+    // for motor driving with PWM from TPM1
+    TPM1SC = 0b00001000 | TPM1_PS;  // edge-aligned PWM on bus clock
+    TPM1MOD = (word)TPM1_MOD;       // set PWM period
+    TPM1C2SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF0 (left motor IN_A)
+    TPM1C3SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF1 (left motor IN_B)
+    TPM1C4SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF2 (right motor IN_A)
+    TPM1C5SC = 0b00101000;  // edge-aligned PWM with high-true pulses for PTF3 (right motor IN_B)
+
+    // for the scheduler tick with timer overflow interrupt of TPM2
+    TPM2SC = 0b01001000 | TPM2_PS;  // enable timer overflow and input capture on bus rate clock
+    TPM2MOD = (word)TPM2_MOD;       // set scheduler tick period
+    TPM2C0SC = 0b01000100;  // enable interrups on positive edge for PTF4 (left tachometer)
+    TPM2C1SC = 0b01000100;  // enable interrups on positive edge for PTF5 (right tachometer)
+    diffLeft = 0;           // difference between two consecutive counter values for left motor
+    diffRight = 0;          // difference between two consecutive counter values for right motor
+    travelDistance = 0;     // tachometer pulses of both wheels left to travel
+    scaleFactor = defaultScaleFactor;   // scale factor used in motor speed control
+    nomSpeed = defaultNomSpeed;         // nominal speed
+    pwLeft = defaultSpeed;  // PWM duty cycle for left motor
+    pwRight = defaultSpeed; // PWM duty cycle for right motor
+    pwMax = defaultPwMax;   // maximum for PWM duty cycle
+    pwMin = defaultPwMin;   // minimum for PWM duty cycle
+    speedStep = defaultSpeedStep;       // maximum change of PWM duty cycle per control period
+    speedGain = defaultSpeedGain;       // proportional gain of the speed feedback
+    tuning = 0;
+    combatState = COMBAT_OFF;   // the combat mode starts it
+    LatencyInit();          // reaction latency histograms
+    ControlInit();          // braking before reversals
+    ModelInit();            // feed-forward of the speed controller
+    WheelInit();            // slip and stall detection
+    HeadingReset();         // heading hold of straight moves
+    GeometryInit();         // travel per tachometer pulse and track width
+
+    // for ADC
+    ADC1CFG = 0b00000000;   // on bus clock, 8-bit conversion
+    APCTL1 = 0b11111111;    // use all 8 pins of port B for ADC
+
+    // for motor status
+    leftMotor = MOTOR_STATUS_STOP;
+    rightMotor = MOTOR_STATUS_STOP;
+    mouseStatus = MOUSE_STATUS_STOP;
+    arcRadius = MOTION_ARC_RADIUS;
+
+    // for touch bars and infrared sensors
+    PTAPE = 0xFF;   // enable port A pullups for touchbar switches and infrared sensors
+    PTADD = 0x00;   // set port A as input
+    WallInit(0);    // digital IR sensors until wall sensing is switched on
+    BatteryInit();  // no duty cycle scaling until the battery is sampled
+    InputInit();    // take the current inputs as their stable levels
+    SchedInit();    // start the periodic tasks
+#ifdef TRACE
+    TraceInit();    // start the trace stream
+#endif
+}
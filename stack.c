@@ -0,0 +1,78 @@
+///
+/// @file       stack.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements probes of the stack painted by 'Start08.c'.
+///
+/// @remarks    The stack grows down from __SEG_END_SSTACK towards
+///             __SEG_START_SSTACK; bytes that still hold STACK_PAINT have
+///             never been used. StackCheck() looks at a single canary byte
+///             STACK_MARGIN bytes above the bottom, so that the TPM2 ISR can
+///             raise stackAlarm before the stack actually overflows.
+///             Only the CodeWarrior build paints the stack; elsewhere the
+///             probes report an empty stack segment.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#ifdef __HIWARE__
+extern char __SEG_START_SSTACK[];
+extern char __SEG_END_SSTACK[];
+#define stackBottom ((byte *)__SEG_START_SSTACK)
+#define stackTop    ((byte *)__SEG_END_SSTACK)
+#else
+static byte stackNone[1];
+#define stackBottom stackNone
+#define stackTop    stackNone
+#endif
+
+
+// size of the stack segment in bytes
+word StackSize(void)
+{
+    return (word)(stackTop - stackBottom);
+}
+
+
+// deepest use of the stack since reset in bytes
+word StackUsed(void)
+{
+    byte *p = stackBottom;
+
+    while (p < stackTop && *p == STACK_PAINT) {
+        p++;
+    }
+    return (word)(stackTop - p);
+}
+
+
+// raise stackAlarm once the stack has come within STACK_MARGIN bytes of
+// its bottom; cheap enough for an ISR
+void StackCheck(void)
+{
+    if (StackSize() > STACK_MARGIN && stackBottom[STACK_MARGIN - 1] != STACK_PAINT) {
+        stackAlarm = 1;
+    }
+}
+
+
+// report the stack use on the SCI
+void StackReport(void)
+{
+    SCISendStr("stack ");
+    SCISendDec(StackUsed());
+    SCISendStr(" of ");
+    SCISendDec(StackSize());
+    SCISendStr(" bytes used");
+    if (stackAlarm) {
+        SCISendStr(", within margin");
+    }
+    SCISendNewLine();
+}
@@ -0,0 +1,114 @@
+///
+/// @file       trace.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the trace stream: raw inputs recorded as they are
+///             read, sent over the SCI for replay by 'host/replay'.
+///
+/// @remarks    Tracing is compiled in when TRACE is defined; the firmware
+///             records through TRACE_RECORD(), which is empty otherwise.
+///             Every record is three bytes: a TRACE_* type and a 16-bit
+///             value, high byte first. Records are queued in a FIFO that the
+///             SCI2 transmit ISR drains; when the FIFO is full, records are
+///             dropped and a TRACE_LOST record with their number follows.
+///             Scheduler ticks are counted rather than recorded one by one:
+///             a TRACE_TICKS record with the ticks completed so far goes
+///             ahead of the next record, so that the records made in a tick
+///             come before the TRACE_TICKS record that includes it.
+///             The stream needs some 4 kB/s at defaultNomPeriod, so raise
+///             baudRate (e.g., 115200, which needs CLOCK_20MHZ) for tracing.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+#ifdef TRACE
+
+static byte traceFifo[TRACE_FIFO_SIZE];
+static byte traceHead;      // next byte to send; written by the SCI ISR
+static byte traceTail;      // next free byte; written by the recorders
+static word traceLost;      // records dropped since the last TRACE_LOST record
+static word traceTicks;     // ticks completed since the last record
+
+
+static byte Free(void)
+{
+    return (byte)((traceHead - traceTail - 1) & (TRACE_FIFO_SIZE - 1));
+}
+
+
+static void Put(byte type, word value)
+{
+    traceFifo[traceTail] = type;
+    traceFifo[(traceTail + 1) & (TRACE_FIFO_SIZE - 1)] = (byte)(value >> 8);
+    traceFifo[(traceTail + 2) & (TRACE_FIFO_SIZE - 1)] = (byte)value;
+    traceTail = (byte)((traceTail + 3) & (TRACE_FIFO_SIZE - 1));
+}
+
+
+// start the stream with a TRACE_START record carrying the TPM2 modulus
+void TraceInit(void)
+{
+    traceHead = traceTail = 0;
+    traceLost = 0;
+    traceTicks = 0;
+    TraceRecord(TRACE_START, TPM2MOD);
+}
+
+
+// queue a record; call with interrupts disabled, as ISRs are
+void TraceRecord(byte type, word value)
+{
+    if (traceTicks != 0) {
+        if (Free() < 6) {
+            traceLost++;
+            return;
+        }
+        Put(TRACE_TICKS, traceTicks);
+        traceTicks = 0;
+    }
+    if (traceLost != 0) {
+        if (Free() < 6) {
+            traceLost++;
+            return;
+        }
+        Put(TRACE_LOST, traceLost);
+        traceLost = 0;
+    }
+    if (Free() < 3) {
+        traceLost++;
+        return;
+    }
+    Put(type, value);
+    SCI2C2_TIE = 1;     // the transmit ISR sends it
+}
+
+
+// count a completed scheduler tick; called at the end of the tick ISR
+void TraceTick(void)
+{
+    traceTicks++;
+}
+
+
+// ISR to send the next byte of the trace stream
+interrupt VectorNumber_Vsci2tx void intSCI2TX()
+{
+    if (!SCI2S1_TDRE) {
+        return;
+    }
+    if (traceHead == traceTail) {
+        SCI2C2_TIE = 0;     // nothing left to send
+        return;
+    }
+    SCI2D = traceFifo[traceHead];
+    traceHead = (byte)((traceHead + 1) & (TRACE_FIFO_SIZE - 1));
+}
+
+#endif  // TRACE
@@ -0,0 +1,215 @@
+///
+/// @file       tune.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the relay feedback auto-tuning of the speed
+///             controller.
+///
+/// @remarks    TuneStart() drives each motor at the duty cycle of its model
+///             for ModelSpeed(nomSpeed), then switches it TUNE_RELAY percent
+///             above and below that whenever the wheel speed crosses the
+///             target by more than TUNE_HYSTERESIS. The wheel settles into a
+///             limit cycle whose amplitude a and period Tu give the ultimate
+///             gain Ku = 4 * TUNE_RELAY / (pi * a) (Astrom and Hagglund). The
+///             Tyreus-Luyben rules for a PI controller, Kp = Ku / 3.2 and
+///             Ti = 2.2 Tu, then set speedGain, the proportional gain, and
+///             scaleFactor, which makes the integral gain of the period
+///             feedback Kp / Ti at nomSpeed; they damp more than those of
+///             Ziegler and Nichols, which swing on slow motors. The wheel with
+///             the smaller gain sets both. Put the mouse on blocks; it takes
+///             a second or two.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static word tuneTime;           // control periods into the experiment
+static word tuneTarget;         // target speed in pulses/s
+static int tuneBias[2];         // duty cycle in the middle of the relay
+static byte tuneHigh[2];        // the relay is switched high
+static word tuneMax[2];         // highest speed in the current cycle
+static word tuneMin[2];         // lowest speed in the current cycle
+static word tuneLast[2];        // tuneTime of the last upward switch; 0 before the first
+static byte tuneCycles[2];      // cycles completed
+static dword tuneSwing[2];      // sum of the peak-to-peak speeds of the counted cycles
+static word tuneLength[2];      // sum of the periods of the counted cycles in control periods
+static word tuneUltimate[2];    // ultimate gain in 1/256 % per pulse/s; 0 if not measured
+static byte tunePeriod[2];      // ultimate period in control periods
+
+
+// start the experiment; TaskControl() steps it instead of ControlSpeed()
+void TuneStart(void)
+{
+    byte i;
+
+    MotionClear();
+    if (nomSpeed <= 0) {
+        return;     // no target speed to tune at
+    }
+    tuneTarget = ModelSpeed((word)nomSpeed);
+    for (i = 0; i < 2; i++) {
+        tuneBias[i] = (motorModel[i].velocity != 0) ? ModelDuty((Motor)i, tuneTarget, 0) : (int)defaultSpeed;
+        tuneHigh[i] = 0;
+        tuneMax[i] = 0;
+        tuneMin[i] = 0xFFFF;
+        tuneLast[i] = 0;
+        tuneCycles[i] = 0;
+        tuneSwing[i] = 0;
+        tuneLength[i] = 0;
+        tuneUltimate[i] = 0;
+        tunePeriod[i] = 0;
+    }
+    tuneTime = 0;
+    tuning = 1;
+}
+
+
+// duty cycle of a motor: the bias, or the relay around it
+static word Relay(Motor motor)
+{
+    int duty = tuneBias[motor];
+
+    if (tuneTime >= TUNE_SETTLE) {
+        duty += tuneHigh[motor] ? TUNE_RELAY : -TUNE_RELAY;
+    }
+    if (duty > (int)pwMax) {
+        return pwMax;
+    }
+    else if (duty < (int)pwMin) {
+        return pwMin;
+    }
+    return (word)duty;
+}
+
+
+// follow the limit cycle of a motor; returns 1 once it has been measured
+static byte Follow(Motor motor)
+{
+    word v = wheelSpeed[motor];
+
+    if (tuneCycles[motor] >= TUNE_SKIP + TUNE_CYCLES) {
+        return 1;
+    }
+    if (tuneTime < TUNE_SETTLE) {
+        tuneHigh[motor] = (v < tuneTarget);
+        return 0;
+    }
+
+    if (v > tuneMax[motor]) {
+        tuneMax[motor] = v;
+    }
+    if (v < tuneMin[motor]) {
+        tuneMin[motor] = v;
+    }
+    if (tuneHigh[motor] && v > tuneTarget + TUNE_HYSTERESIS) {
+        tuneHigh[motor] = 0;
+    }
+    else if (!tuneHigh[motor] && v + TUNE_HYSTERESIS < tuneTarget) {
+        // an upward switch closes a cycle; the first ones are transient
+        tuneHigh[motor] = 1;
+        if (tuneLast[motor] != 0) {
+            if (++tuneCycles[motor] > TUNE_SKIP) {
+                tuneSwing[motor] += tuneMax[motor] - tuneMin[motor];
+                tuneLength[motor] += tuneTime - tuneLast[motor];
+            }
+        }
+        tuneLast[motor] = tuneTime;
+        tuneMax[motor] = 0;
+        tuneMin[motor] = 0xFFFF;
+    }
+    return 0;
+}
+
+
+// the ultimate gain and period of a motor from its counted cycles
+static void Ultimate(Motor motor)
+{
+    dword swing = tuneSwing[motor] / TUNE_CYCLES;     // twice the amplitude
+
+    if (swing == 0) {
+        return;
+    }
+    // 4 h / (pi a) = 8 h / (pi * swing), in 1/256 %
+    tuneUltimate[motor] = (word)(((dword)8 * TUNE_RELAY * 256 * 100) / (314 * swing));
+    tunePeriod[motor] = (byte)(tuneLength[motor] / TUNE_CYCLES);
+}
+
+
+// the PI gains from the smaller ultimate gain of the two motors
+static void Gains(void)
+{
+    byte m = (tuneUltimate[MOTOR_LEFT] <= tuneUltimate[MOTOR_RIGHT]) ? MOTOR_LEFT : MOTOR_RIGHT;
+    dword kp, ki, scale;
+
+    if (tuneUltimate[m] == 0 || tunePeriod[m] == 0) {
+        return;     // no limit cycle; keep the gains
+    }
+    kp = (dword)tuneUltimate[m] * 10 / 32;                 // 1/256 % per pulse/s
+    ki = (kp << 8) * 10 / (22 * (dword)tunePeriod[m]);     // 1/65536 % per pulse/s per control period
+
+    // a period error of one count is a speed error of tuneTarget^2 / TPM2_HZ
+    // pulses/s at nomSpeed, so the divisor of the period error is
+    // nomSpeed / (ki * tuneTarget)
+    scale = (ki != 0) ? ((dword)nomSpeed << 16) / (ki * tuneTarget) : 0;
+    speedGain = (word)kp;
+    scaleFactor = (scale == 0) ? 1 : (scale > 32767) ? 32767 : (int)scale;
+}
+
+
+// one control period of the experiment; called by TaskControl()
+void TuneStep(void)
+{
+    byte done;
+
+    done = Follow(MOTOR_LEFT);
+    done &= Follow(MOTOR_RIGHT);
+    if (!done && tuneTime < TUNE_TIMEOUT) {
+        pwLeft = Relay(MOTOR_LEFT);
+        pwRight = Relay(MOTOR_RIGHT);
+        ControlMotor(MOTOR_LEFT, MOTOR_ACTION_FORWARD);
+        ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_FORWARD);
+        tuneTime++;
+        return;
+    }
+
+    ControlMotor(MOTOR_LEFT, MOTOR_ACTION_STOP);
+    ControlMotor(MOTOR_RIGHT, MOTOR_ACTION_STOP);
+    if (done) {
+        Ultimate(MOTOR_LEFT);
+        Ultimate(MOTOR_RIGHT);
+        Gains();
+    }
+    tuning = 0;
+}
+
+
+// report the ultimate gains and periods, and the gains, on the SCI
+void TuneReport(void)
+{
+    static char *names[] = { "Left  ", "Right " };
+    byte i;
+
+    for (i = 0; i < 2; i++) {
+        SCISendStr(names[i]);
+        if (tuneUltimate[i] == 0) {
+            SCISendStr("no limit cycle\r\n");
+            continue;
+        }
+        SCISendStr("Ku ");
+        SCISendDec(tuneUltimate[i]);
+        SCISendStr(" (1/256 %), Tu ");
+        SCISendDec((word)tunePeriod[i] * controlPeriod);
+        SCISendStr(" ms\r\n");
+    }
+    SCISendStr("speedGain ");
+    SCISendDec(speedGain);
+    SCISendStr(", scaleFactor ");
+    SCISendDec((word)scaleFactor);
+    SCISendNewLine();
+}
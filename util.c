@@ -43,11 +43,12 @@ byte BitClear(byte Bit_position, byte Var_old)
 //--------------------------------------------------------
 // Functions for delay
 //--------------------------------------------------------
-void Delay(int a)
+// busy wait for about 'ms' milliseconds; see delayLoopCycles in "mouse.h"
+void Delay(int ms)
 {
     int b=0,c=0;
-    for (b=0;b<a;b++){
-        for(c=0;c<100;c++);
+    for (b=0;b<ms;b++){
+        for(c=0;c<(int)delayLoopsPerMs;c++);
     }
 }
 
@@ -55,10 +56,24 @@ void Delay(int a)
 //------------------------------------------------------------------------------
 // Functions for ADC module (e.g., for read values from line sensors)
 //------------------------------------------------------------------------------
+// convert outside the ISRs; WallSample() and BatterySample() convert in the
+// tick ISR, which would otherwise abort this conversion, start its own and
+// read the result, so that ADC1SC1_COCO never sets for the wait below
 byte ADCRead(byte ch)
 {
-    word value;
+    byte value;
     
+    DisableInterrupts;
+    value = ADCConvert(ch);
+    TRACE_RECORD((byte)(TRACE_ADC | ch), value);
+    EnableInterrupts;
+    return value;
+}
+
+
+// convert without tracing or masking; for ISRs, which trace the result themselves
+byte ADCConvert(byte ch)
+{
     ADC1SC1 = ch;
     
     while (ADC1SC1_COCO != 1)
@@ -0,0 +1,139 @@
+///
+/// @file       wall.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements analog wall sensing with the front infrared sensors
+///             and the wall-centering correction of the speed controller.
+///
+/// @remarks    With wallSensing set, TaskSense() alternates
+///             between reading the receivers with the emitters off (ambient
+///             light) and with them on; the difference is linearised to a
+///             distance in mm through wallTable. ControlSpeed() then offsets
+///             the balance of the motors by WallCorrection(), which steers
+///             the mouse towards the middle of a corridor.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+// distance in mm for signals of 0, 16, ..., 256; the reflected light falls
+// off with the square of the distance, i.e., 320 / sqrt(signal) here.
+// Calibrate against the actual sensors and walls.
+static const byte wallTable[17] = {
+    WALL_NONE, 80, 57, 46, 40, 36, 33, 30, 28, 27, 25, 24, 23, 22, 21, 21, 20
+};
+
+static const byte wallChannel[2] = { infraredAnalogLeft, infraredAnalogRight };
+static byte wallAmbient[2];     // readings with the emitters off
+static byte wallLit;            // the emitters are on
+
+
+// distance in mm for an emitter-on minus emitter-off signal
+static byte Linearise(byte signal)
+{
+    byte i = signal >> 4;
+    byte f = signal & 0x0F;
+
+    return (byte)(wallTable[i] - (((word)(wallTable[i] - wallTable[i + 1]) * f) >> 4));
+}
+
+
+// switch wall sensing on or off; the distances read WALL_NONE until sampled
+void WallInit(byte enable)
+{
+    infraredEmitter = 0;
+    PTCDD |= infraredEmitterMask;   // the emitter driver is an output
+    wallLit = 0;
+    wallDistance[MOTOR_LEFT] = wallDistance[MOTOR_RIGHT] = WALL_NONE;
+    wallSensing = enable;
+}
+
+
+// one step of the sampling sequence; called by TaskSense()
+void WallSample(void)
+{
+    byte i, lit, signal;
+
+    if (!wallSensing) {
+        return;
+    }
+    for (i = 0; i < 2; i++) {
+        if (!wallLit) {
+            wallAmbient[i] = ADCConvert(wallChannel[i]);
+            TRACE_RECORD(TRACE_ADC | wallChannel[i], wallAmbient[i]);
+            continue;
+        }
+        lit = ADCConvert(wallChannel[i]);
+        TRACE_RECORD(TRACE_ADC | wallChannel[i], lit);
+        signal = (lit > wallAmbient[i]) ? (byte)(lit - wallAmbient[i]) : 0;
+        wallDistance[i] = Linearise(signal);
+    }
+    wallLit = !wallLit;
+    infraredEmitter = wallLit;  // lit for the next sample; light needs time to settle
+}
+
+
+// offset in TPM2 counts of diffLeft - diffRight that steers the mouse to the
+// middle of a corridor; positive slows the left motor, i.e., veers left
+int WallCorrection(void)
+{
+    int error, limit;
+    long bias;
+    byte left = wallDistance[MOTOR_LEFT];
+    byte right = wallDistance[MOTOR_RIGHT];
+
+    if (!wallSensing || nomSpeed <= 0
+        || leftMotor != MOTOR_STATUS_FORWARD || rightMotor != MOTOR_STATUS_FORWARD) {
+        return 0;
+    }
+
+    // more room on the left than on the right gives a positive error
+    if (left < WALL_PRESENT && right < WALL_PRESENT) {
+        error = (int)left - (int)right;
+    }
+    else if (left < WALL_PRESENT) {
+        error = 2 * ((int)left - WALL_CENTRE);
+    }
+    else if (right < WALL_PRESENT) {
+        error = 2 * (WALL_CENTRE - (int)right);
+    }
+    else {
+        return 0;   // no wall to follow
+    }
+
+    bias = ((long)error * nomSpeed) >> WALL_SHIFT;
+    limit = nomSpeed >> 2;
+    if (bias > limit) {
+        return limit;
+    }
+    if (bias < -limit) {
+        return -limit;
+    }
+    return (int)bias;
+}
+
+
+// send the wall distances over the SCI
+void WallReport(void)
+{
+    int correction;
+
+    SCISendStr("Wall left ");
+    SCISendDec(wallDistance[MOTOR_LEFT]);
+    SCISendStr(" mm, right ");
+    SCISendDec(wallDistance[MOTOR_RIGHT]);
+    SCISendStr(" mm, correction ");
+    correction = WallCorrection();
+    if (correction < 0) {
+        SCISendChar('-');
+        correction = -correction;
+    }
+    SCISendDec((word)correction);
+    SCISendStr("\r\n");
+}
@@ -0,0 +1,215 @@
+///
+/// @file       wheel.c
+/// @author     agent <agent@local>
+/// @date       2026-10-19
+///
+/// @brief      Implements the detection of wheel slip, stall and pushing
+///             from the commanded duty cycles and the measured wheel speeds.
+///
+/// @remarks    WheelCheck() runs in every control period, before the speed
+///             controller. It passes the duty cycle of each motor through
+///             its motor model, as a first-order lag with the time constant
+///             of the model, to predict the speed of the wheel, and compares
+///             the prediction with the speed from the tachometer. A driven
+///             wheel far slower than predicted is stalled; one far faster
+///             than predicted while the other is not has lost traction; both
+///             faster, or a wheel turning that is not driven, mean that
+///             something pushes the mouse. A condition must hold for
+///             WHEEL_CONFIRM control periods before it is flagged in
+///             wheelState. ControlSpeed() holds its feedback while a wheel is
+///             flagged, and the mode loops read wheelState to react. Without
+///             a motor model nothing is flagged.
+///
+/// @copyright  This software is written and distributed under the GNU General
+///             Public License Version 2 (http://www.gnu.org/licenses/gpl-2.0.html).
+///             You must not remove this notice, or any other, from this software.
+///
+
+
+#include "mouse.h"	// for the declaration of types, constants, variables and functions
+
+
+static long wheelPredicted[2];  // predicted speed in pulses/s, Q8
+static word wheelTach[2];       // tachCount in the last control period
+static byte wheelIdle[2];       // control periods since the last tachometer pulse
+static byte wheelPulses[2];     // tachometer pulses, up to 2, since wheelDrive changed
+static signed char wheelDrive[2];   // direction of the last control period: 1, -1, or 0 if not driven
+static byte wheelCount[2][3];   // control periods that each condition has held
+
+
+// clear the predictions and the flags
+void WheelInit(void)
+{
+    byte i, j;
+
+    for (i = 0; i < 2; i++) {
+        wheelPredicted[i] = 0;
+        wheelTach[i] = tachCount[i];
+        wheelIdle[i] = 0xFF;
+        wheelPulses[i] = 0;
+        wheelDrive[i] = 0;
+        for (j = 0; j < 3; j++) {
+            wheelCount[i][j] = 0;
+        }
+        wheelSpeed[i] = 0;
+        wheelState[i] = 0;
+    }
+}
+
+
+// measured speed of a wheel in pulses/s: the period of the last pulse, but
+// no more than one pulse in the time since then. Until two pulses have come
+// since the motor was last switched on, off or round, the period means
+// nothing and the result is only that bound, WHEEL_UNKNOWN at first.
+static word Measure(Motor motor, signed char drive)
+{
+    word speed = WHEEL_UNKNOWN, bound;
+
+    if (drive != wheelDrive[motor]) {
+        wheelDrive[motor] = drive;
+        wheelPulses[motor] = 0;
+        wheelIdle[motor] = 0;
+    }
+    if (tachCount[motor] != wheelTach[motor]) {
+        if (wheelPulses[motor] < 2) {
+            wheelPulses[motor] += (byte)((word)(tachCount[motor] - wheelTach[motor]) > 1 ? 2 : 1);
+        }
+        wheelTach[motor] = tachCount[motor];
+        wheelIdle[motor] = 0;
+    }
+    else if (wheelIdle[motor] != 0xFF) {
+        wheelIdle[motor]++;
+    }
+
+    if (wheelPulses[motor] >= 2) {
+        speed = ModelSpeed((motor == MOTOR_LEFT) ? diffLeft : diffRight);
+    }
+    if (wheelIdle[motor] != 0) {
+        bound = (word)(1000 / ((word)wheelIdle[motor] * controlPeriod));
+        if (speed > bound) {
+            speed = bound;
+        }
+    }
+    return speed;
+}
+
+
+// advance the predicted speed of a wheel by one control period, and return
+// its magnitude; the prediction is signed, so that it passes through zero
+// when the motor reverses, as the wheel does
+static word Predict(Motor motor, signed char drive)
+{
+    const MotorModel *m = &motorModel[motor];
+    word duty = (motor == MOTOR_LEFT) ? pwLeft : pwRight;
+    long target = 0;
+    long alpha;
+
+    if (drive != 0 && duty > m->friction) {
+        target = ((long)(duty - m->friction) << 24) / m->velocity;     // steady-state speed, Q8
+        if (drive < 0) {
+            target = -target;
+        }
+    }
+
+    // share of the step covered in a control period, Q8: controlPeriod over
+    // the time constant accel / velocity, but at most all of it
+    alpha = ((long)controlPeriod * m->velocity * 256 / 1000) / (m->accel ? m->accel : 1);
+    if (alpha > 256 || m->accel == 0) {
+        alpha = 256;
+    }
+    wheelPredicted[motor] += ((target - wheelPredicted[motor]) * alpha) >> 8;
+    return (word)(((wheelPredicted[motor] < 0) ? -wheelPredicted[motor] : wheelPredicted[motor]) >> 8);
+}
+
+
+// count how long a condition has held; 1 once it has for WHEEL_CONFIRM periods
+static byte Confirm(Motor motor, byte index, byte holds)
+{
+    byte *count = &wheelCount[motor][index];
+
+    if (!holds) {
+        *count = 0;
+        return 0;
+    }
+    if (*count < WHEEL_CONFIRM) {
+        (*count)++;
+    }
+    return (*count >= WHEEL_CONFIRM);
+}
+
+
+// check both wheels; called by TaskControl() in every control period
+void WheelCheck(void)
+{
+    byte i, driven[2], over[2];
+    signed char drive[2];
+    word predicted[2], measured[2];
+    byte state;
+
+    drive[MOTOR_LEFT] = (leftMotor == MOTOR_STATUS_FORWARD) ? 1 : (leftMotor == MOTOR_STATUS_REVERSE) ? -1 : 0;
+    drive[MOTOR_RIGHT] = (rightMotor == MOTOR_STATUS_FORWARD) ? 1 : (rightMotor == MOTOR_STATUS_REVERSE) ? -1 : 0;
+    for (i = 0; i < 2; i++) {
+        driven[i] = (drive[i] != 0);
+        measured[i] = Measure((Motor)i, drive[i]);
+        wheelSpeed[i] = (wheelPulses[i] >= 2) ? measured[i] : 0;
+    }
+    if (motorModel[MOTOR_LEFT].velocity == 0 || motorModel[MOTOR_RIGHT].velocity == 0) {
+        wheelState[MOTOR_LEFT] = wheelState[MOTOR_RIGHT] = 0;
+        return;     // no model to predict with
+    }
+
+    for (i = 0; i < 2; i++) {
+        predicted[i] = Predict((Motor)i, drive[i]);
+
+        // faster than predicted; for a wheel not driven, turning at all
+        if (wheelPulses[i] < 2) {
+            over[i] = 0;    // no speed yet, only a bound
+        }
+        else if (driven[i]) {
+            over[i] = (wheelSpeed[i] > predicted[i] + (predicted[i] >> 2) + WHEEL_MIN_SPEED);
+        }
+        else {
+            over[i] = (wheelSpeed[i] > WHEEL_MIN_SPEED && predicted[i] < WHEEL_MIN_SPEED);
+        }
+    }
+
+    for (i = 0; i < 2; i++) {
+        state = 0;
+        if (Confirm((Motor)i, 0, driven[i] && predicted[i] >= WHEEL_MIN_SPEED
+                                 && measured[i] < (predicted[i] >> 2))) {
+            state |= WHEEL_STALL;
+        }
+        if (Confirm((Motor)i, 1, driven[i] && over[i] && !over[1 - i])) {
+            state |= WHEEL_SLIP;
+        }
+        if (Confirm((Motor)i, 2, over[i] && (!driven[i] || over[1 - i]))) {
+            state |= WHEEL_PUSHED;
+        }
+        wheelState[i] = state;
+    }
+}
+
+
+// report the measured speeds and the flags of both wheels on the SCI
+void WheelReport(void)
+{
+    static char *names[] = { "Left  ", "Right " };
+    byte i;
+
+    for (i = 0; i < 2; i++) {
+        SCISendStr(names[i]);
+        SCISendDec(wheelSpeed[i]);
+        SCISendStr(" pulses/s, predicted ");
+        SCISendDec((word)(((wheelPredicted[i] < 0) ? -wheelPredicted[i] : wheelPredicted[i]) >> 8));
+        if (wheelState[i] & WHEEL_STALL) {
+            SCISendStr(", stall");
+        }
+        if (wheelState[i] & WHEEL_SLIP) {
+            SCISendStr(", slip");
+        }
+        if (wheelState[i] & WHEEL_PUSHED) {
+            SCISendStr(", pushed");
+        }
+        SCISendStr("\r\n");
+    }
+}